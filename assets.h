@@ -0,0 +1,306 @@
+// Generato da host/ffasset.c a partire da assets/: non modificare a mano,
+// rigenerare con "make -C host assets".
+
+#define START_CW 5
+#define START_CH 4
+
+// Chunk della zona di partenza: LZ77UnCompWram/RLUnCompWram -> Chunk.t.
+static const u32 START_BLOB[] = {
+    // (0,0) LZ77 64 byte
+    0x00008010, 0x00403340, 0x11112113, 0x21081121, 0x00661312, 0x11111100,
+    0x1007f0d6, 0x0fb02107, 0x002f0021, 0x213c1236, 0x20071011, 0x00077000,
+    0xbc121150, 0x60120f70, 0x2009201f, 0x00070037,
+    // (1,0) LZ77 40 byte
+    0x00008010, 0x00403356, 0x21004011, 0x00a00850, 0xf0127721, 0x20003013,
+    0x36702118, 0x14402890, 0xd03ba0c0, 0x00000048,
+    // (2,0) LZ77 36 byte
+    0x00008010, 0x00403343, 0x11211111, 0x06400020, 0xb012113f, 0x8000f004,
+    0x500bf026, 0xc012b048, 0x21104ec0,
+    // (3,0) LZ77 36 byte
+    0x00008010, 0x00403356, 0x12005011, 0x10e00960, 0x0410bb21, 0xf0003044,
+    0x2107b007, 0x07f017f0, 0x00000080,
+    // (4,0) LZ77 44 byte
+    0x00008010, 0x00403356, 0x21000011, 0x00600410, 0x0300b522, 0x1011a012,
+    0x00004400, 0x78074024, 0xf007f014, 0xa007f007, 0x00000007,
+    // (0,1) LZ77 32 byte
+    0x00008010, 0x30111336, 0x2107b000, 0x07400fc0, 0x27d0db12, 0xf0210790,
+    0x21077017, 0x303017f0,
+    // (1,1) LZ77 44 byte
+    0x00008010, 0x20112137, 0x12063000, 0x10700c30, 0x217f1160, 0x0a201b90,
+    0x13802010, 0x3e4000c0, 0x33640010, 0x19f00020, 0x0a101211,
+    // (2,1) LZ77 40 byte
+    0x00008010, 0x00f01143, 0x13111112, 0x00100300, 0x0f50137a, 0x07f01a40,
+    0xf02107a0, 0x00e03317, 0x7017f000, 0x00000007,
+    // (3,1) LZ77 40 byte
+    0x00008010, 0x30441123, 0x11121100, 0x05100010, 0x0920217f, 0x16300040,
+    0x229000d0, 0x28f02ea0, 0xa044f0c0, 0x00000000,
+    // (4,1) LZ77 36 byte
+    0x00008010, 0x0000444d, 0x00f01114, 0xf0120070, 0x00f0a212, 0x12269012,
+    0x21f02111, 0x14c0a011, 0x000e3012,
+    // (0,2) LZ77 32 byte
+    0x00008010, 0x3011133b, 0x7007f000, 0x00005507, 0xf0ea07f0, 0x0007f007,
+    0x17d01207, 0x0017a021,
+    // (1,2) LZ77 36 byte
+    0x00008010, 0x2111110b, 0x12003011, 0x0e800740, 0x2111120b, 0x15003055,
+    0x07f007f0, 0xe007f0d0, 0x17d02507,
+    // (2,2) LZ77 36 byte
+    0x00008010, 0x0020115a, 0xf0063013, 0x0f901207, 0x1f908f12, 0xa0211112,
+    0x301f400f, 0xc0177030, 0x07d00fd0,
+    // (3,2) RLE 32 byte
+    0x00008030, 0x120211bc, 0x118f2111, 0x118a2100, 0x11112103, 0x00118812,
+    0x00118a12, 0x00000022,
+    // (4,2) LZ77 32 byte
+    0x00008010, 0x00f01168, 0xf0210000, 0x12111112, 0x8012f0fc, 0xf0322015,
+    0xb036f037, 0x00000027,
+    // (0,3) LZ77 40 byte
+    0x00008010, 0x11111307, 0x00005511, 0x074007f0, 0xf012123d, 0x2007f017,
+    0x12000007, 0x11700740, 0x07f007f0, 0x00002f10,
+    // (1,3) LZ77 32 byte
+    0x00008010, 0x00305557, 0x15074025, 0x07f007f0, 0x551b07f0, 0x00f01115,
+    0xf0210010, 0x0019b012,
+    // (2,3) LZ77 40 byte
+    0x00008010, 0x0020115b, 0xb0063013, 0x0f902107, 0x70bf0c00, 0x0580121f,
+    0x1d200020, 0x00f02230, 0xe0800090, 0x00000023,
+    // (3,3) LZ77 36 byte
+    0x00008010, 0x00f0116b, 0x10120010, 0x0a202104, 0x30fc0540, 0xf022d006,
+    0xa000e000, 0x2134c038, 0x00000011,
+    // (4,3) LZ77 32 byte
+    0x00008010, 0x0020115f, 0xe0063012, 0xf017f000, 0x7c269022, 0x3036a021,
+    0xf013400d, 0x00002000,
+};
+// 760 byte compressi per 2560 di tile
+
+// Offset (in u32) di ogni chunk in START_BLOB, riga per riga.
+static const u16 START_OFS[START_CW*START_CH] = {
+    0, 16, 26, 35, 44, 55, 63, 74, 84, 94,
+    103, 111, 120, 129, 137, 145, 155, 163, 173, 182,
+};
+
+// Texel della panoramica: il tile al centro di ogni chunk.
+static const u8 START_OV[START_CW*START_CH] = {
+    2, 1, 1, 4, 4, 1, 1, 1, 1, 1,
+    5, 5, 1, 1, 1, 5, 5, 1, 1, 1,
+};
+
+enum {
+    S_TITLE,
+    S_HUD_WOOD,
+    S_HUD_STONE,
+    S_HUD_ORBS,
+    S_HUD_COMP,
+    S_HUD_SEP,
+    S_DAY,
+    S_NIGHT,
+    S_HUD_MISSIONS,
+    S_HUD_OF,
+    S_HUD_MENU,
+    S_TOWER_HIT,
+    S_CANT_BUILD,
+    S_NO_MATERIALS,
+    S_TOO_MANY_BUILDINGS,
+    S_BUILT,
+    S_NOBODY,
+    S_WALL,
+    S_WATER,
+    S_CHOP_OK,
+    S_CHOP_FAIL,
+    S_FORAGE_NONE,
+    S_POST_EMPTY,
+    S_POST_YIELD,
+    S_FARM_EMPTY,
+    S_FARM_YIELD,
+    S_FIRE_HEAL,
+    S_CRAFT_ORB,
+    S_CRAFT_POST,
+    S_CRAFT_NONE,
+    S_NO_ORBS,
+    S_CREATURE_APPEARS,
+    S_ORB_MISS,
+    S_BOSS_TRACES,
+    S_TALK_HEAD,
+    S_TALK_MORE,
+    S_TALK_GIFT,
+    S_TALK_END,
+    S_BATTLE_INTRO,
+    S_BATTLE_STATS,
+    S_ACT_ATTACK,
+    S_ACT_SPECIAL,
+    S_ACT_CATCH,
+    S_ACT_FLEE,
+    S_HIT,
+    S_SPECIAL_HIT,
+    S_BATTLE_NO_ORBS,
+    S_THROW,
+    S_CAUGHT,
+    S_BROKE_FREE,
+    S_WON,
+    S_BOX_IN,
+    S_BOX_FULL,
+    S_BOX_UNSAVED,
+    S_BOX_FOREIGN,
+    S_MENU,
+    S_MENU_RENDER,
+    S_RENDER_BG,
+    S_RENDER_TEXT,
+    S_MENU_PROF,
+    S_ON,
+    S_OFF,
+    S_MENU_SEED,
+    S_MENU_BACK,
+    S_SAVED,
+    S_LOADED,
+    S_NO_SAVE,
+    S_HELP_TITLE,
+    S_HELP_MISSION,
+    S_HELP,
+    S_BOX_TITLE,
+    S_BOX_FILTER,
+    S_BOX_ALL,
+    S_BOX_BY_SPECIES,
+    S_BOX_BY_CATCH,
+    S_BOX_ROW,
+    S_BOX_BAD,
+    S_BOX_LOCKED_UNSAVED,
+    S_BOX_LOCKED_FOREIGN,
+    S_BOX_KEYS,
+};
+#define STR_COUNT    96
+#define STR_LINE_MAX 186    // la piu' lunga escluse le conversazioni
+#define STR_DEPTH    4
+
+// Codice -> coppia di codici; {0,0} = byte letterale.
+static const u8 STR_PAIR[256][2] = {
+    [1]={105,32}, [2]={97,32}, [3]={114,101}, [4]={111,32}, [5]={111,110}, [6]={97,116},
+    [7]={101,114}, [8]={116,114}, [9]={111,46}, [11]={45,45}, [13]={111,115}, [14]={111,114},
+    [15]={58,32}, [16]={32,32}, [17]={97,108}, [18]={37,100}, [19]={37,115}, [20]={105,101},
+    [21]={46,10}, [22]={32,99}, [23]={105,110}, [24]={116,116}, [25]={114,97}, [26]={117,110},
+    [27]={108,32}, [28]={97,110}, [29]={101,32}, [30]={11,11}, [31]={105,99}, [34]={97,114},
+    [35]={99,99}, [36]={110,101}, [42]={41,32}, [53]={101,103}, [55]={20,8}, [60]={110,111},
+    [61]={83,102}, [62]={112,7}, [63]={66,111}, [64]={63,120}, [74]={83,84}, [75]={32,80},
+    [81]={105,115}, [87]={46,46}, [88]={97,103}, [89]={101,110}, [90]={103,105}, [92]={108,105},
+    [94]={116,111}, [95]={32,76}, [96]={28,99}, [106]={4,100}, [107]={108,97}, [119]={13,8},
+    [121]={119,117}, [123]={17,118}, [124]={10,10}, [125]={116,105}, [126]={84,32}, [127]={5,32},
+    [129]={113,117}, [130]={74,65}, [131]={130,82}, [132]={26,32}, [133]={97,35}, [134]={43,18},
+    [135]={97,3}, [136]={19,32}, [137]={101,3}, [138]={105,5}, [139]={62,32}, [140]={115,123},
+    [141]={98,7}, [142]={100,111}, [143]={10,83}, [144]={65,32}, [145]={2,112}, [146]={69,76},
+    [147]={146,69}, [149]={147,67}, [150]={27,64}, [151]={107,118}, [152]={151,14}, [153]={6,116},
+    [154]={99,5}, [155]={13,115}, [156]={117,114}, [157]={30,30}, [158]={61,137}, [159]={45,32},
+    [160]={15,19}, [161]={92,141}, [162]={116,32}, [163]={39,32}, [164]={66,47}, [165]={164,131},
+    [166]={88,90}, [167]={25,102}, [168]={114,111}, [169]={44,32}, [170]={110,2}, [171]={97,21},
+    [172]={111,103}, [173]={108,1}, [174]={95,53}, [175]={13,116}, [176]={1,152}, [177]={101,115},
+    [179]={81,99}, [180]={3,6}, [181]={3,32}, [182]={100,105}, [183]={110,4}, [184]={16,16},
+    [185]={3,109}, [186]={185,1}, [187]={61,7}, [188]={111,15}, [189]={37,45}, [190]={6,4},
+    [191]={97,1}, [192]={117,115}, [193]={150,32}, [194]={101,163}, [196]={140,6}, [197]={109,5},
+    [198]={20,110}, [199]={165,126}, [200]={100,55}, [201]={200,111}, [202]={89,117}, [203]={83,149},
+    [204]={116,14}, [205]={82,65}, [206]={105,21}, [207]={1,99}, [208]={75,55}, [209]={175,106},
+    [210]={209,176}, [211]={121,179}, [212]={84,14}, [213]={212,3}, [214]={213,24}, [215]={70,34},
+    [216]={215,109}, [217]={22,180}, [218]={217,117}, [219]={60,24},
+};
+static const u16 STR_OFS[STR_COUNT] = {
+    0, 35, 40, 44, 48, 57, 59, 64, 69, 76, 78, 85,
+    100, 113, 132, 148, 155, 177, 197, 209, 222, 234, 251, 268,
+    281, 297, 307, 329, 344, 355, 380, 396, 408, 422, 444, 448,
+    457, 480, 493, 514, 530, 539, 550, 555, 560, 573, 583, 591,
+    606, 619, 626, 639, 651, 663, 684, 704, 767, 777, 780, 784,
+    798, 800, 804, 814, 822, 833, 845, 854, 862, 872, 973, 982,
+    998, 1003, 1009, 1014, 1033, 1050, 1089, 1157, 1224, 1228, 1358, 1366,
+    1408, 1415, 1455, 1462, 1476, 1482, 1490, 1502, 1515, 1522, 1536, 1542,
+};
+static const u8 STR_DATA[] = {
+    70,97,26,97,70,114,5,125,7,71,66,144,226,128,148,32,69,110,104,96,
+    101,100,10,80,186,144,139,23,105,122,105,135,87,46,0,76,53,60,58,0,
+    208,97,58,0,32,158,58,0,67,111,109,112,88,110,105,58,0,16,0,71,
+    105,14,60,0,78,111,24,101,0,77,81,115,138,105,58,0,47,0,16,131,
+    84,58,77,202,0,76,2,214,2,97,98,98,153,29,132,36,109,31,9,0,
+    78,127,112,117,111,207,121,105,181,129,105,46,0,77,6,7,105,17,1,23,
+    115,117,102,102,31,198,116,1,139,19,46,0,84,168,112,112,101,22,121,122,
+    138,1,36,27,197,100,9,0,67,121,105,94,160,33,0,78,5,22,39,194,
+    36,115,115,26,4,154,22,117,1,112,34,107,181,129,105,46,0,85,110,145,
+    135,116,29,98,108,111,35,2,105,27,112,97,115,115,166,9,0,76,39,97,
+    99,129,2,116,1,211,101,46,0,84,88,173,132,25,109,188,43,49,174,110,
+    9,0,76,39,17,141,4,3,115,81,116,101,46,0,70,114,192,99,105,9,
+    87,32,36,115,115,132,23,154,8,9,0,73,27,80,210,4,110,127,104,2,
+    96,14,145,168,142,24,9,0,134,174,60,169,134,208,2,100,17,75,210,9,
+    0,76,2,216,32,110,127,104,2,96,14,145,168,142,24,9,0,134,174,110,
+    106,17,108,2,216,46,0,70,17,195,178,22,17,142,15,207,111,109,112,88,
+    110,1,115,207,117,25,110,9,0,67,167,116,15,187,2,43,49,32,40,94,
+    162,18,41,0,80,210,4,112,13,105,122,138,6,9,0,77,6,7,105,17,
+    1,23,115,117,102,102,31,198,116,1,62,22,167,162,25,112,105,100,9,0,
+    78,127,104,191,158,46,32,67,167,116,22,127,203,84,46,0,85,170,99,180,
+    156,2,97,112,112,135,33,0,76,96,1,26,2,187,2,2,118,117,111,116,
+    9,0,72,191,8,111,118,190,8,133,29,100,101,27,66,155,46,32,43,50,
+    32,158,33,0,19,58,124,0,10,65,15,154,116,23,117,97,0,10,72,191,
+    114,31,101,118,117,94,15,134,174,60,169,134,208,97,169,134,32,187,171,0,
+    10,80,186,144,62,22,5,116,23,117,135,46,0,85,110,32,136,40,19,42,
+    115,101,108,118,6,31,4,97,112,112,135,33,124,0,72,80,15,18,47,18,
+    16,65,98,105,92,116,97,160,124,0,65,24,133,4,25,112,105,142,0,77,
+    155,2,115,112,101,99,105,17,101,0,67,153,117,25,0,70,117,103,90,0,
+    67,111,108,112,179,1,139,18,46,184,16,32,0,77,155,2,19,15,18,46,
+    184,16,0,78,198,116,29,158,33,32,0,76,96,105,9,87,32,40,18,32,
+    118,115,32,18,42,0,10,67,153,156,190,19,33,75,186,65,87,46,0,143,
+    1,161,97,33,32,0,143,154,102,105,24,111,33,75,186,65,87,46,0,136,
+    118,2,36,193,40,18,47,18,41,46,0,64,32,112,20,60,15,136,204,170,
+    161,9,0,136,204,170,161,188,140,2,108,145,34,125,116,2,139,192,135,32,
+    105,150,46,0,136,204,170,161,188,105,193,194,100,1,132,17,8,4,197,100,
+    4,196,9,0,70,97,26,97,70,114,5,125,7,71,66,144,226,128,148,32,
+    77,202,10,157,157,157,124,65,42,77,81,115,138,1,38,32,65,105,117,94,
+    10,68,69,74,205,42,64,218,3,143,149,84,42,83,65,86,69,16,32,82,
+    42,76,79,65,68,10,0,76,42,82,89,100,137,114,160,10,0,66,71,0,
+    116,177,94,0,71,73,85,39,42,80,168,102,105,108,7,160,10,0,5,0,
+    111,102,102,0,143,101,109,101,15,37,108,117,10,0,165,84,42,73,110,201,
+    10,0,143,123,190,115,117,32,83,205,77,33,0,10,67,34,31,6,106,2,
+    83,205,77,33,0,10,78,177,115,132,196,166,9,0,77,81,115,138,105,58,
+    124,0,91,37,99,93,32,136,159,19,10,0,10,159,77,117,111,118,105,125,
+    169,25,35,172,173,76,53,60,47,80,55,171,159,203,84,15,99,167,162,25,
+    112,105,100,4,40,158,44,75,13,94,41,21,45,95,47,82,15,101,182,102,
+    31,105,4,115,101,108,101,122,138,6,111,59,95,43,65,22,211,206,159,82,
+    43,144,108,96,105,2,187,171,159,78,80,67,32,100,28,183,23,182,122,1,
+    29,100,5,206,10,199,139,192,99,105,3,46,0,64,218,3,16,18,47,18,
+    10,0,84,105,112,188,189,56,115,32,79,114,100,23,101,160,10,0,84,117,
+    24,105,0,115,112,101,99,20,0,99,153,117,25,0,37,99,32,189,57,115,
+    189,56,115,72,80,37,51,100,47,189,52,100,0,40,3,99,14,100,32,105,
+    108,108,53,90,98,105,108,101,41,0,10,73,193,194,108,53,190,191,196,166,
+    58,10,140,2,108,145,34,125,116,2,40,203,126,36,108,10,109,202,42,139,
+    192,34,108,9,124,199,23,201,0,10,73,193,194,100,1,132,17,8,4,197,
+    142,44,10,96,14,2,23,32,26,4,115,108,111,162,182,10,196,166,9,32,
+    83,1,161,2,129,28,142,10,89,8,97,109,98,1,103,173,115,108,111,162,
+    115,5,106,105,10,129,177,116,4,197,100,9,124,199,23,201,0,83,85,47,
+    71,73,85,163,115,99,14,114,1,95,47,82,32,125,112,111,143,149,126,14,
+    100,23,101,10,144,112,3,110,100,1,40,2,115,129,97,100,114,145,198,97,
+    10,16,115,99,97,109,98,105,2,99,127,108,39,117,108,125,109,111,41,10,
+    199,23,201,0,83,166,111,0,66,89,118,202,94,44,22,121,24,111,3,21,
+    82,133,172,173,108,53,183,29,112,55,171,65,112,114,1,203,126,62,22,167,
+    116,21,12,80,175,1,100,176,4,29,216,10,112,168,100,117,154,106,2,115,
+    111,92,15,204,110,97,10,2,25,35,172,108,20,3,22,127,65,21,76,29,
+    214,29,97,98,98,153,5,4,105,10,36,109,31,1,219,156,110,1,118,31,
+    23,206,12,76,101,218,181,111,108,116,181,107,10,115,129,97,100,114,2,118,
+    28,183,36,150,58,10,131,84,169,112,111,1,68,69,74,205,21,0,67,133,
+    105,6,114,31,101,0,68,1,219,29,101,109,7,103,5,4,36,109,31,206,
+    85,170,214,2,97,105,117,116,2,109,111,108,116,9,10,79,35,104,105,4,
+    17,108,39,89,7,90,171,0,71,117,34,182,28,111,0,78,101,27,98,13,
+    99,4,2,110,14,100,45,177,116,10,115,207,101,108,2,132,66,155,32,219,
+    156,110,9,10,80,3,112,34,6,1,98,101,36,21,0,82,133,172,92,94,
+    3,0,82,133,172,173,49,48,174,183,29,54,208,97,46,0,66,96,4,152,
+    111,0,67,211,1,26,75,210,9,0,68,105,102,177,2,38,32,67,105,98,
+    111,0,67,211,1,49,32,214,2,29,49,32,216,46,0,67,133,105,6,111,
+    3,0,67,153,156,2,50,218,181,182,118,7,115,101,46,0,77,23,105,98,
+    155,0,83,154,102,105,103,103,1,105,27,98,155,32,219,156,183,36,27,66,
+    13,99,9,0,
+};
+// 2871 byte di testo in 1564 byte + 148 coppie
+
+#define NPC_DEF_COUNT 3
+static const NpcDef NPC_DEFS[NPC_DEF_COUNT] = {
+    {6,6, 3,2,0, 80,81},
+    {22,26, 0,2,1, 82,83},
+    {60,12, 0,0,2, 84,85},
+};
+
+#define MISSION_DEF_COUNT 5
+static const MissionDef MISSION_DEFS[MISSION_DEF_COUNT] = {
+    {86,87},
+    {88,89},
+    {90,91},
+    {92,93},
+    {94,95},
+};
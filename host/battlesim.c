@@ -0,0 +1,129 @@
+/*
+    Simulatore di battaglie headless per il bilanciamento: gioca N battaglie
+    per ogni coppia (specie, strategia) con battle_step() di main.c, su piu'
+    thread, e riporta percentuali di vittoria/cattura/fuga e turni medi.
+
+    Ogni battaglia ha il suo stato RNG derivato da (seed, cella, indice):
+    il risultato non dipende dal numero di thread ne' dall'ordine.
+
+    Uso: ffsim [-n battaglie=100000] [-t thread=nproc] [-s seed=1]
+               [-o sfere=5] [-a tipo_alleato=3] [-N]   (-N: notte)
+*/
+
+#define main ff_game_main
+#include "../main.c"
+#undef main
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+void ff_bench_record(int scope, unsigned long long ns){ (void)scope; (void)ns; }
+
+typedef enum { ST_ATTACK=0, ST_SPECIAL, ST_CATCH, ST_WEAKEN, ST_COUNT } Strategy;
+
+static const char* STRATEGY_NAMES[ST_COUNT] = { "attacco", "speciale", "cattura", "indebolisci" };
+
+#define SIM_MAX_TURNS 200   // oltre: conta come fuga (strategia bloccata)
+#define SIM_JOB       4096  // battaglie per lavoro preso da un thread
+#define CELLS         (SP_COUNT*ST_COUNT)
+
+typedef struct {
+    unsigned long long battles, won, caught, fled, turns;
+} CellStat;
+
+static unsigned long long sim_battles = 100000;
+static u32 sim_seed = 1;
+static int sim_orbs = 5, sim_ally = TYPE_GRASS, sim_night = 0;
+static unsigned long long jobs_total;
+static unsigned long long next_job;         // contatore atomico condiviso
+
+static BattleAction choose(Strategy s, const Battle* b){
+    switch(s){
+        case ST_ATTACK:  return BA_ATTACK;
+        case ST_SPECIAL: return BA_SPECIAL;
+        case ST_CATCH:   return b->orbs>0 ? BA_CATCH : BA_FLEE;
+        default:         // indebolisci fino a meta', poi lancia finche' ci sono sfere
+            if (b->wild.hp*2 > b->wild.max_hp) return BA_ATTACK;
+            return b->orbs>0 ? BA_CATCH : BA_FLEE;
+    }
+}
+
+static void sim_one(int cell, unsigned long long i, CellStat* out){
+    u32 st = hash32(sim_seed ^ hash32((u32)cell*0x9E3779B9u ^ hash32((u32)i ^ (u32)(i>>32))));
+    if (!st) st=1;
+    Creature w = spawn_creature((SpeciesId)(cell/ST_COUNT), &st);
+    Battle b; battle_init(&b, &w, (ElemType)sim_ally, sim_night, sim_orbs);
+    BattleResult r = BR_ONGOING;
+    int steps=0;
+    while (r==BR_ONGOING && steps++<SIM_MAX_TURNS) r = battle_step(&b, choose((Strategy)(cell%ST_COUNT), &b), &st);
+    out->battles++; out->turns+=b.turns;
+    if (r==BR_WON) out->won++;
+    else if (r==BR_CAUGHT) out->caught++;
+    else out->fled++;
+}
+
+static void* worker(void* arg){
+    CellStat* local = arg;                  // CELLS voci private: niente condivisione nel ciclo
+    unsigned long long per_cell = (sim_battles+SIM_JOB-1)/SIM_JOB;
+    for (;;){
+        unsigned long long j = __atomic_fetch_add(&next_job, 1, __ATOMIC_RELAXED);
+        if (j>=jobs_total) break;
+        int cell = (int)(j/per_cell);
+        unsigned long long lo = (j%per_cell)*SIM_JOB, hi = lo+SIM_JOB;
+        if (hi>sim_battles) hi=sim_battles;
+        for (unsigned long long i=lo; i<hi; ++i) sim_one(cell, i, &local[cell]);
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv){
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i=1; i<argc; ++i){
+        const char* a=argv[i];
+        if (!strcmp(a,"-N")) { sim_night=1; continue; }
+        if (a[0]!='-' || !a[1] || a[2] || i+1>=argc){ fprintf(stderr, "uso: %s [-n N] [-t T] [-s seed] [-o sfere] [-a tipo] [-N]\n", argv[0]); return 2; }
+        const char* v=argv[++i];
+        switch(a[1]){
+            case 'n': sim_battles=strtoull(v,NULL,0); break;
+            case 't': nthreads=strtol(v,NULL,0); break;
+            case 's': sim_seed=(u32)strtoul(v,NULL,0); break;
+            case 'o': sim_orbs=atoi(v); break;
+            case 'a': sim_ally=atoi(v); break;
+            default:  fprintf(stderr, "opzione sconosciuta: %s\n", a); return 2;
+        }
+    }
+    if (nthreads<1) nthreads=1;
+    if (sim_ally<0 || sim_ally>=TYPE_COUNT) sim_ally=TYPE_GRASS;
+    jobs_total = (unsigned long long)CELLS * ((sim_battles+SIM_JOB-1)/SIM_JOB);
+
+    pthread_t* th = calloc((size_t)nthreads, sizeof(*th));
+    CellStat* part = calloc((size_t)nthreads*CELLS, sizeof(*part));
+    unsigned long long t0 = ff_host_now_ns();
+    for (long t=0; t<nthreads; ++t) pthread_create(&th[t], NULL, worker, &part[t*CELLS]);
+    for (long t=0; t<nthreads; ++t) pthread_join(th[t], NULL);
+    unsigned long long dt = ff_host_now_ns()-t0;
+
+    CellStat tot[CELLS]; memset(tot, 0, sizeof(tot));
+    for (long t=0; t<nthreads; ++t)
+        for (int c=0; c<CELLS; ++c){
+            const CellStat* p=&part[t*CELLS+c];
+            tot[c].battles+=p->battles; tot[c].won+=p->won; tot[c].caught+=p->caught;
+            tot[c].fled+=p->fled; tot[c].turns+=p->turns;
+        }
+
+    printf("seed %lu  sfere %d  alleato %s  %s  %llu battaglie/cella\n",
+           (unsigned long)sim_seed, sim_orbs, ELEM_NAME[sim_ally], sim_night?"notte":"giorno", sim_battles);
+    printf("%-10s %-12s %8s %8s %8s %8s\n", "specie", "strategia", "vitt%", "catt%", "fuga%", "turni");
+    for (int c=0; c<CELLS; ++c){
+        const CellStat* s=&tot[c];
+        double n = s->battles ? (double)s->battles : 1.0;
+        printf("%-10s %-12s %8.2f %8.2f %8.2f %8.2f\n", SPECIES[c/ST_COUNT].name, STRATEGY_NAMES[c%ST_COUNT],
+               100.0*s->won/n, 100.0*s->caught/n, 100.0*s->fled/n, s->turns/n);
+    }
+    unsigned long long all = (unsigned long long)CELLS*sim_battles;
+    fprintf(stderr, "%llu battaglie in %.3f s su %ld thread (%.0f battaglie/s)\n",
+            all, dt/1e9, nthreads, dt ? all*1e9/dt : 0.0);
+    free(th); free(part);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+    Runner di benchmark host: esegue il main loop di main.c per N frame
+    con un input scriptato e riporta il costo per chiamata degli scope del
+    profiler di main.c (PROF), compreso il frame.
+
+    Uso: ffbench [frame=3600] [seed=1] [-s] [-r log | -p log]
+      -s      stampa lo schermo finale
+      -r log  registra lo stream dei tasti (RLE) nel file log
+      -p log  riproduce il file log al posto dell'input scriptato
+*/
+
+#include <gba_console.h>
+#include <gba_input.h>
+#include <gba_video.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int ff_game_main(void);
+
+typedef struct {
+    unsigned long long calls, total, min, max;
+} Stat;
+
+#define MAX_SCOPES 16
+static Stat scopes[MAX_SCOPES];
+static unsigned frame_limit = 3600;
+static jmp_buf run_end;
+
+#define LOG_CAP 65536
+static u32 input_log[LOG_CAP];
+
+static void stat_add(Stat* s, unsigned long long ns){
+    if (s->calls==0 || ns<s->min) s->min=ns;
+    if (ns>s->max) s->max=ns;
+    s->calls++; s->total+=ns;
+}
+
+void ff_bench_record(int scope, unsigned long long ns){
+    if (scope>=0 && scope<MAX_SCOPES) stat_add(&scopes[scope], ns);
+}
+
+// Input scriptato --------------------------------------------------------
+// Percorso a quadrato (60 frame per lato) con A premuto ogni 16 frame:
+// raccolta, incontri e battaglie si alternano. Ogni 240 frame L+A
+// (costruzione), ogni 300 SELECT (craft rapido).
+static u16 script_keys(unsigned f){
+    static const u16 dirs[4] = { KEY_RIGHT, KEY_DOWN, KEY_LEFT, KEY_UP };
+    if (f < 8) return (f==2) ? KEY_A : 0;          // schermata titolo
+    u16 k = dirs[(f/60)%4];
+    if (f%16==0) k |= KEY_A;
+    if (f%240 >= 236){ k = KEY_L; if (f%240==239) k |= KEY_A; }
+    if (f%300==150) k = KEY_SELECT;
+    return k;
+}
+
+static void on_vblank(void){
+    if (ff_host_frame >= frame_limit) longjmp(run_end, 1);
+    REG_KEYINPUT = (u16)(~script_keys(ff_host_frame) & 0x03ff);
+}
+
+// Report -----------------------------------------------------------------
+static void print_stat(const char* name, const Stat* s){
+    if (s->calls==0){ printf("%-22s %8s\n", name, "-"); return; }
+    printf("%-22s %8llu %10llu %10llu %10llu %10.3f\n", name, s->calls,
+        s->total/s->calls, s->min, s->max, (double)s->total/1e6);
+}
+
+int main(int argc, char** argv){
+    int dump = 0;
+    unsigned seed = 1;
+    int pos = 0;
+    const char* rec_path = NULL;
+    const char* play_path = NULL;
+    for(int i=1;i<argc;i++){
+        if (strcmp(argv[i], "-s")==0){ dump=1; continue; }
+        if (strcmp(argv[i], "-r")==0 && i+1<argc){ rec_path=argv[++i]; continue; }
+        if (strcmp(argv[i], "-p")==0 && i+1<argc){ play_path=argv[++i]; continue; }
+        if (pos==0) frame_limit = (unsigned)strtoul(argv[i], NULL, 0);
+        else if (pos==1) seed = (unsigned)strtoul(argv[i], NULL, 0);
+        pos++;
+    }
+
+    REG_VCOUNT = (u16)seed;     // entra nel seme di sessione (vedi main.c)
+    REG_KEYINPUT = (u16)(~script_keys(0) & 0x03ff);
+    ff_host_vblank_hook = on_vblank;
+    if (play_path){
+        FILE* f = fopen(play_path, "rb");
+        if (!f){ perror(play_path); return 1; }
+        size_t n = fread(input_log, sizeof(u32), LOG_CAP, f);
+        fclose(f);
+        input_replay(input_log, (u32)n);
+    } else if (rec_path){
+        input_record(input_log, LOG_CAP);
+    }
+    if (setjmp(run_end)==0) ff_game_main();
+
+    if (rec_path){
+        FILE* f = fopen(rec_path, "wb");
+        if (!f){ perror(rec_path); return 1; }
+        fwrite(input_log, sizeof(u32), input_log_len(), f);
+        fclose(f);
+    }
+
+    printf("FaunaFrontier host bench: %u frame, seed %u%s\n\n", frame_limit, seed, play_path?" (replay)":"");
+    printf("%-22s %8s %10s %10s %10s %10s\n", "scope", "calls", "avg(ns)", "min(ns)", "max(ns)", "total(ms)");
+    for(int i=0;i<MAX_SCOPES && prof_scope_name(i);i++) print_stat(prof_scope_name(i), &scopes[i]);
+
+    if (dump){
+        printf("\n");
+        for(int y=0;y<FF_CON_H;y++) printf("|%.*s|\n", FF_CON_W, ff_host_screen[y]);
+    }
+    return 0;
+}
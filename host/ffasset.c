@@ -0,0 +1,349 @@
+/*
+    Compilatore degli asset: legge assets/ e scrive assets.h, incluso da
+    main.c. Gira sull'host al build; il risultato e' versionato, cosi' il
+    build GBA (devkitARM) non ha bisogno di questo tool.
+
+    - start.txt: zona di partenza, un glifo di TILE_PROPS per cella, lato
+      multiplo di 16. Ogni chunk 16x16 diventa un blob nel formato dei
+      decompressori del BIOS (LZ77 tipo 0x10 o RLE tipo 0x30, il piu'
+      corto), gia' impacchettato a 4 bit come Chunk.t: chunk_generate() lo
+      decomprime direttamente nello slot della cache.
+    - strings.txt, npcs.txt, missions.txt: tutti i testi in una tabella di
+      stringhe compressa (ID S_* per quelle con nome), piu' le tabelle const
+      NPC_DEFS e MISSION_DEFS che ne usano gli ID.
+
+    Uso: ffasset dir_asset file_uscita
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK     16
+#define CHUNK_RAW (CHUNK*CHUNK/2)
+#define MAX_W     256
+#define MAX_H     256
+#define MAX_BLOB  (CHUNK_RAW + CHUNK_RAW/8 + 8)
+
+// Glifo -> TileId: stesso ordine dell'enum e di TILE_PROPS in main.c.
+static const char TILE_GLYPHS[] = ".GY#WS=TFHP";
+
+static const char* dir;
+static int errors;
+
+static FILE* open_asset(const char* name){
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "r");
+    if (!f){ fprintf(stderr, "ffasset: non trovo %s\n", path); exit(1); }
+    return f;
+}
+static void fail(const char* file, int line, const char* what){
+    fprintf(stderr, "%s/%s:%d: %s\n", dir, file, line, what);
+    errors++;
+}
+// Riga senza a capo finale; 0 a fine file.
+static int read_line(FILE* f, char* buf, int n){
+    if (!fgets(buf, n, f)) return 0;
+    buf[strcspn(buf, "\r\n")] = 0;
+    return 1;
+}
+
+// Compressione -----------------------------------------------------------
+// Intestazione comune: tipo nel byte basso, dimensione decompressa sopra.
+static int put_header(unsigned char* out, int type, int size){
+    out[0]=(unsigned char)type; out[1]=(unsigned char)size;
+    out[2]=(unsigned char)(size>>8); out[3]=(unsigned char)(size>>16);
+    return 4;
+}
+
+// LZ77 del BIOS: un byte di flag ogni 8 blocchi (bit 7 = primo); bit a 1 =
+// riferimento di 2 byte, lunghezza-3 nei 4 bit alti, distanza-1 nei 12 bassi.
+// Ricerca greedy, a questi volumi basta.
+static int lz77(const unsigned char* src, int n, unsigned char* out){
+    int o = put_header(out, 0x10, n), flag_at = 0, bit = 8;
+    for (int i=0; i<n; ){
+        if (bit==8){ flag_at=o; out[o++]=0; bit=0; }
+        int best_len=0, best_d=0;
+        for (int d=1; d<=i && d<=4096; ++d){
+            int l=0;
+            while (l<18 && i+l<n && src[i+l]==src[i+l-d]) l++;
+            if (l>best_len){ best_len=l; best_d=d; }
+        }
+        if (best_len>=3){
+            out[flag_at] |= (unsigned char)(0x80>>bit);
+            out[o++] = (unsigned char)(((best_len-3)<<4) | ((best_d-1)>>8));
+            out[o++] = (unsigned char)(best_d-1);
+            i += best_len;
+        } else out[o++] = src[i++];
+        bit++;
+    }
+    return o;
+}
+
+// RLE del BIOS: byte di flag, bit 7 = ripetizione di (flag&0x7F)+3 copie del
+// byte che segue, altrimenti (flag&0x7F)+1 byte letterali.
+static int rle(const unsigned char* src, int n, unsigned char* out){
+    int o = put_header(out, 0x30, n);
+    for (int i=0; i<n; ){
+        int run=1;
+        while (run<130 && i+run<n && src[i+run]==src[i]) run++;
+        if (run>=3){ out[o++]=(unsigned char)(0x80|(run-3)); out[o++]=src[i]; i+=run; continue; }
+        int lit=0;
+        while (lit<128 && i+lit<n){
+            if (i+lit+2<n && src[i+lit]==src[i+lit+1] && src[i+lit]==src[i+lit+2]) break;
+            lit++;
+        }
+        out[o++]=(unsigned char)(lit-1);
+        memcpy(out+o, src+i, (size_t)lit); o+=lit; i+=lit;
+    }
+    return o;
+}
+
+// Zona di partenza ---------------------------------------------------------
+static unsigned char start_map[MAX_H][MAX_W];
+static int start_w, start_h;
+
+static void read_start(){
+    FILE* f = open_asset("start.txt");
+    char buf[MAX_W+8];
+    while (read_line(f, buf, sizeof(buf))){
+        int w = (int)strlen(buf);
+        if (start_h==MAX_H){ fail("start.txt", start_h+1, "mappa troppo alta"); break; }
+        if (!start_h) start_w = w;
+        if (w!=start_w || w>MAX_W){ fail("start.txt", start_h+1, "righe di lunghezza diversa"); break; }
+        for (int x=0; x<w; ++x){
+            const char* g = strchr(TILE_GLYPHS, buf[x]);
+            if (!g || !buf[x]){ fail("start.txt", start_h+1, "glifo sconosciuto"); g=TILE_GLYPHS; }
+            start_map[start_h][x] = (unsigned char)(g-TILE_GLYPHS);
+        }
+        start_h++;
+    }
+    fclose(f);
+    if (!start_w || start_w%CHUNK || start_h%CHUNK) fail("start.txt", start_h, "lati non multipli di 16");
+}
+
+static void emit_start(FILE* out){
+    int cw=start_w/CHUNK, ch=start_h/CHUNK, words=0, raw_total=0;
+    unsigned ofs[(MAX_W/CHUNK)*(MAX_H/CHUNK)];
+    fprintf(out, "#define START_CW %d\n#define START_CH %d\n\n", cw, ch);
+    fprintf(out, "// Chunk della zona di partenza: LZ77UnCompWram/RLUnCompWram -> Chunk.t.\n");
+    fprintf(out, "static const u32 START_BLOB[] = {\n");
+    for (int cy=0; cy<ch; ++cy) for (int cx=0; cx<cw; ++cx){
+        unsigned char raw[CHUNK_RAW]={0}, a[MAX_BLOB], b[MAX_BLOB];
+        for (int i=0; i<CHUNK*CHUNK; ++i){
+            unsigned t = start_map[cy*CHUNK + i/CHUNK][cx*CHUNK + i%CHUNK];
+            raw[i>>1] |= (unsigned char)((i&1) ? t<<4 : t);
+        }
+        int na=lz77(raw, CHUNK_RAW, a), nb=rle(raw, CHUNK_RAW, b);
+        unsigned char* blob = na<=nb ? a : b;
+        int n = na<=nb ? na : nb;
+        while (n&3) blob[n++]=0;   // il BIOS vuole sorgenti allineate a 4
+        ofs[cy*cw+cx]=(unsigned)words;
+        fprintf(out, "    // (%d,%d) %s %d byte\n   ", cx, cy, na<=nb?"LZ77":"RLE", n);
+        for (int i=0; i<n; i+=4){
+            fprintf(out, " 0x%08x,", blob[i] | blob[i+1]<<8 | blob[i+2]<<16 | (unsigned)blob[i+3]<<24);
+            if ((i/4)%6==5 && i+4<n) fprintf(out, "\n   ");
+        }
+        fprintf(out, "\n");
+        words += n/4; raw_total += CHUNK_RAW;
+    }
+    fprintf(out, "};\n// %d byte compressi per %d di tile\n\n", words*4, raw_total);
+    fprintf(out, "// Offset (in u32) di ogni chunk in START_BLOB, riga per riga.\n");
+    fprintf(out, "static const u16 START_OFS[START_CW*START_CH] = {");
+    for (int i=0; i<cw*ch; ++i) fprintf(out, "%s%u,", i%10 ? " " : "\n    ", ofs[i]);
+    fprintf(out, "\n};\n\n// Texel della panoramica: il tile al centro di ogni chunk.\n");
+    fprintf(out, "static const u8 START_OV[START_CW*START_CH] = {");
+    for (int i=0; i<cw*ch; ++i)
+        fprintf(out, "%s%u,", i%10 ? " " : "\n    ", start_map[(i/cw)*CHUNK+CHUNK/2][(i%cw)*CHUNK+CHUNK/2]);
+    fprintf(out, "\n};\n\n");
+}
+
+// Testi --------------------------------------------------------------------
+// Tutte le stringhe finiscono in un'unica tabella compressa a coppie di byte
+// (BPE): ogni codice non usato dal testo diventa una coppia di codici, scelta
+// ogni volta tra le coppie piu' frequenti. Il gioco le espande un byte alla
+// volta con una pila di STR_DEPTH codici, senza buffer per la stringa intera.
+#define MAX_STRINGS 512
+#define MAX_DEFS    32
+#define TEXT_LEN    256
+#define TALK_LEN    2048
+
+static unsigned char* pool[MAX_STRINGS];
+static int pool_len[MAX_STRINGS], pool_n, named_n, line_max;
+static char named[MAX_STRINGS][48];
+
+static int str_add(const char* s, int is_line){
+    if (pool_n==MAX_STRINGS){ fprintf(stderr, "ffasset: troppe stringhe\n"); exit(1); }
+    int n=(int)strlen(s);
+    pool[pool_n]=(unsigned char*)strdup(s); pool_len[pool_n]=n;
+    if (is_line && n>line_max) line_max=n;
+    return pool_n++;
+}
+
+// strings.txt: NOME "testo", con gli escape \n \" \\ ; diventa S_NOME.
+static void read_strings(){
+    FILE* f = open_asset("strings.txt");
+    char buf[2*TEXT_LEN], txt[TEXT_LEN];
+    int ln=0;
+    while (read_line(f, buf, sizeof(buf))){
+        ln++;
+        if (!buf[0] || buf[0]=='#') continue;
+        int k=0;
+        while (buf[k]=='_' || (buf[k]>='A' && buf[k]<='Z') || (buf[k]>='0' && buf[k]<='9')) k++;
+        const char* q=buf+k+strspn(buf+k, " \t");
+        if (!k || k>=40 || *q!='"'){ fail("strings.txt", ln, "atteso NOME \"testo\""); continue; }
+        int n=0;
+        for (q++; *q && *q!='"' && n<TEXT_LEN-1; q++){
+            if (*q=='\\' && q[1]){ q++; txt[n++] = *q=='n' ? '\n' : *q; }
+            else txt[n++]=*q;
+        }
+        if (*q!='"'){ fail("strings.txt", ln, "testo non chiuso o troppo lungo"); continue; }
+        txt[n]=0;
+        memcpy(named[named_n], buf, (size_t)k); named[named_n][k]=0;
+        named_n++;
+        str_add(txt, 1);
+    }
+    fclose(f);
+}
+
+static int bpe_depth(const unsigned char pair[256][2], int c){
+    if (!pair[c][0]) return 0;
+    int l=bpe_depth(pair, pair[c][0])+1, r=bpe_depth(pair, pair[c][1]);
+    return l>r ? l : r;
+}
+
+static void emit_strings(FILE* out){
+    static int count[256][256];
+    unsigned char pair[256][2]={{0}}, used[256]={0};
+    int raw=0;
+    for (int i=0; i<pool_n; ++i){ raw+=pool_len[i]+1; for (int j=0; j<pool_len[i]; ++j) used[pool[i][j]]=1; }
+    int codes=0;
+    for (int code=1; code<256; ++code){
+        if (used[code]) continue;
+        memset(count, 0, sizeof(count));
+        int best=0, ba=0, bb=0;
+        for (int i=0; i<pool_n; ++i)
+            for (int j=0; j+1<pool_len[i]; ++j){
+                int c=++count[pool[i][j]][pool[i][j+1]];
+                if (c>best){ best=c; ba=pool[i][j]; bb=pool[i][j+1]; }
+            }
+        if (best<4) break;                  // 2 byte di tabella: sotto 4 usi non rende
+        pair[code][0]=(unsigned char)ba; pair[code][1]=(unsigned char)bb;
+        for (int i=0; i<pool_n; ++i){
+            int o=0;
+            for (int j=0; j<pool_len[i]; ){
+                if (j+1<pool_len[i] && pool[i][j]==ba && pool[i][j+1]==bb){ pool[i][o++]=(unsigned char)code; j+=2; }
+                else pool[i][o++]=pool[i][j++];
+            }
+            pool_len[i]=o;
+        }
+        codes++;
+    }
+    int depth=0, data=0;
+    for (int c=1; c<256; ++c){ int d=bpe_depth(pair, c); if (d>depth) depth=d; }
+    fprintf(out, "enum {\n");
+    for (int i=0; i<named_n; ++i) fprintf(out, "    S_%s,\n", named[i]);
+    fprintf(out, "};\n#define STR_COUNT    %d\n#define STR_LINE_MAX %d    // la piu' lunga escluse le conversazioni\n"
+                 "#define STR_DEPTH    %d\n\n", pool_n, line_max, depth);
+    fprintf(out, "// Codice -> coppia di codici; {0,0} = byte letterale.\n");
+    fprintf(out, "static const u8 STR_PAIR[256][2] = {");
+    for (int c=1, k=0; c<256; ++c) if (pair[c][0]) fprintf(out, "%s[%d]={%d,%d},", k++%6 ? " " : "\n    ", c, pair[c][0], pair[c][1]);
+    fprintf(out, "\n};\nstatic const u16 STR_OFS[STR_COUNT] = {");
+    for (int i=0; i<pool_n; ++i){ fprintf(out, "%s%d,", i%12 ? " " : "\n    ", data); data+=pool_len[i]+1; }
+    fprintf(out, "\n};\nstatic const u8 STR_DATA[] = {");
+    for (int i=0, k=0; i<pool_n; ++i)
+        for (int j=0; j<=pool_len[i]; ++j) fprintf(out, "%s%d,", k++%20 ? "" : "\n    ", j<pool_len[i] ? pool[i][j] : 0);
+    fprintf(out, "\n};\n// %d byte di testo in %d byte + %d coppie\n\n", raw, data, codes);
+}
+
+typedef struct { int x, y, wood, stone, orb, name, talk; } Npc;
+static Npc npc[MAX_DEFS];
+static int npc_n;
+static int mission_id[MAX_DEFS][2], mission_n;
+
+// npcs.txt: "@ x y nome legno pietra sfere", poi le battute rientrate; una
+// battuta "--" chiude la pagina. La conversazione e' una stringa sola.
+static void read_npcs(){
+    static char talk[MAX_DEFS][TALK_LEN];
+    char names[MAX_DEFS][64];
+    char buf[TEXT_LEN+8];
+    int ln=0;
+    FILE* f = open_asset("npcs.txt");
+    while (read_line(f, buf, sizeof(buf))){
+        ln++;
+        if (!buf[0] || buf[0]=='#') continue;
+        if (buf[0]=='@'){
+            if (npc_n==MAX_DEFS){ fail("npcs.txt", ln, "troppi NPC"); break; }
+            Npc* p=&npc[npc_n];
+            if (sscanf(buf+1, "%d %d %63s %d %d %d", &p->x, &p->y, names[npc_n], &p->wood, &p->stone, &p->orb)!=6
+                || p->x<0 || p->y<0) fail("npcs.txt", ln, "atteso \"@ x y nome legno pietra sfere\"");
+            npc_n++;
+        } else {
+            const char* s=buf+strspn(buf, " \t");
+            if (!npc_n || s==buf){ fail("npcs.txt", ln, "battuta fuori da un NPC"); continue; }
+            char* t=talk[npc_n-1];
+            size_t n=strlen(t);
+            if (n+strlen(s)+2>=TALK_LEN){ fail("npcs.txt", ln, "conversazione troppo lunga"); continue; }
+            if (!strcmp(s, "--")) strcpy(t+n, "\f");
+            else { strcpy(t+n, s); strcat(t+n, "\n"); }
+        }
+    }
+    fclose(f);
+    for (int i=0; i<npc_n; ++i){ npc[i].name=str_add(names[i], 1); npc[i].talk=str_add(talk[i], 0); }
+}
+
+static void emit_npcs(FILE* out){
+    fprintf(out, "#define NPC_DEF_COUNT %d\nstatic const NpcDef NPC_DEFS[NPC_DEF_COUNT] = {\n", npc_n);
+    for (int i=0; i<npc_n; ++i){
+        const Npc* p=&npc[i];
+        fprintf(out, "    {%d,%d, %d,%d,%d, %d,%d},\n", p->x, p->y, p->wood, p->stone, p->orb, p->name, p->talk);
+    }
+    fprintf(out, "};\n\n");
+}
+
+// missions.txt: "titolo | descrizione".
+static void read_missions(){
+    char buf[2*TEXT_LEN];
+    int ln=0;
+    FILE* f = open_asset("missions.txt");
+    while (read_line(f, buf, sizeof(buf))){
+        ln++;
+        if (!buf[0] || buf[0]=='#') continue;
+        char* bar=strstr(buf, " | ");
+        if (!bar){ fail("missions.txt", ln, "atteso \"titolo | descrizione\""); continue; }
+        if (mission_n==MAX_DEFS){ fail("missions.txt", ln, "troppe missioni"); break; }
+        *bar=0;
+        mission_id[mission_n][0]=str_add(buf, 1);
+        mission_id[mission_n][1]=str_add(bar+3, 1);
+        mission_n++;
+    }
+    fclose(f);
+}
+
+static void emit_missions(FILE* out){
+    fprintf(out, "#define MISSION_DEF_COUNT %d\nstatic const MissionDef MISSION_DEFS[MISSION_DEF_COUNT] = {\n", mission_n);
+    for (int i=0; i<mission_n; ++i) fprintf(out, "    {%d,%d},\n", mission_id[i][0], mission_id[i][1]);
+    fprintf(out, "};\n");
+}
+
+int main(int argc, char** argv){
+    if (argc!=3){ fprintf(stderr, "uso: %s dir_asset file_uscita\n", argv[0]); return 2; }
+    dir=argv[1];
+    read_start();
+    read_strings();                     // per prime: gli S_* partono da 0
+    read_npcs();
+    read_missions();
+    if (errors) return 1;
+    FILE* out = fopen(argv[2], "w");
+    if (!out){ perror(argv[2]); return 1; }
+    fprintf(out, "// Generato da host/ffasset.c a partire da assets/: non modificare a mano,\n"
+                 "// rigenerare con \"make -C host assets\".\n\n");
+    emit_start(out);
+    emit_strings(out);
+    emit_npcs(out);
+    emit_missions(out);
+    fclose(out);
+    if (errors){ remove(argv[2]); return 1; }
+    return 0;
+}
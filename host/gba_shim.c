@@ -0,0 +1,159 @@
+/*
+    Shim host delle API libgba usate da main.c.
+    - IO/SRAM come array, registri con le stesse macro di libgba
+    - console 30x20 con il sottoinsieme di escape usato dal gioco
+    - VBlankIntrWait() fa avanzare il frame e chiama il runner
+*/
+
+#include <gba_base.h>
+#include <gba_console.h>
+#include <gba_dma.h>
+#include <gba_input.h>
+#include <gba_interrupt.h>
+#include <gba_systemcalls.h>
+#include <gba_video.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+u8 ff_host_io[0x400] ALIGN(4);
+u8 ff_host_pal[0x400] ALIGN(4);
+u8 ff_host_vram[0x18000] ALIGN(4);
+u8 ff_host_oam[0x400] ALIGN(4);
+u8 ff_host_sram[0x10000];
+
+void (*ff_host_vblank_hook)(void);
+unsigned ff_host_frame;
+
+unsigned long long ff_host_now_ns(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec*1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+// Interrupt & BIOS -----------------------------------------------------------
+static IntFn vblank_fn;
+
+void irqInit(void){ vblank_fn = 0; }
+void irqEnable(int mask){ (void)mask; }
+void irqSet(irqMASK mask, IntFn function){ if (mask & IRQ_VBLANK) vblank_fn = function; }
+
+// Il gestore della VBlank gira qui, prima che il runner campioni il frame.
+void VBlankIntrWait(void){
+    if (vblank_fn) vblank_fn();
+    ff_host_frame++;
+    if (ff_host_vblank_hook) ff_host_vblank_hook();
+}
+
+// Intestazione: tipo nel byte basso (0x10 LZ77, 0x30 RLE), dimensione sopra.
+void LZ77UnCompWram(const void *source, void *dest){
+    const u8* s = (const u8*)source + 4;
+    u8* d = dest;
+    u32 size = *(const u32*)source >> 8;
+    for (u32 o=0; o<size; ){
+        u8 flags = *s++;
+        for (int b=0; b<8 && o<size; ++b, flags<<=1){
+            if (!(flags & 0x80)){ d[o++] = *s++; continue; }
+            u32 len = (s[0]>>4) + 3, disp = ((s[0]&15)<<8 | s[1]) + 1;
+            s += 2;
+            while (len-- && o<size){ d[o] = d[o-disp]; o++; }
+        }
+    }
+}
+
+void RLUnCompWram(const void *source, void *dest){
+    const u8* s = (const u8*)source + 4;
+    u8* d = dest;
+    u32 size = *(const u32*)source >> 8;
+    for (u32 o=0; o<size; ){
+        u8 f = *s++;
+        if (f & 0x80){ for (u32 n=(f&0x7F)+3u; n-- && o<size; ) d[o++] = *s; s++; }
+        else { for (u32 n=(f&0x7F)+1u; n-- && o<size; ) d[o++] = *s++; }
+    }
+}
+
+// DMA ------------------------------------------------------------------------
+// Solo trasferimenti immediati con indirizzi crescenti: una memcpy di
+// count unita' da 16 o 32 bit (count 0 vale 0x10000 come sul DMA3).
+void ff_host_dma3(const void *source, void *dest, u32 mode){
+    u32 count = mode & 0xffff;
+    if (!count) count = 0x10000;
+    memcpy(dest, source, count * ((mode & DMA32) ? 4u : 2u));
+}
+
+// Input ----------------------------------------------------------------------
+static u16 keys_cur, keys_prev;
+
+void scanKeys(void){
+    keys_prev = keys_cur;
+    keys_cur = (u16)(~REG_KEYINPUT & 0x03ff);
+}
+u16 keysDown(void){ return keys_cur & ~keys_prev; }
+u16 keysUp(void){ return ~keys_cur & keys_prev; }
+u16 keysHeld(void){ return keys_cur; }
+
+// Console --------------------------------------------------------------------
+// Stesse regole della console libgba: a capo differito a fine riga,
+// scroll quando si supera l'ultima riga, "\x1b[y;xH" con coordinate 0-based.
+char ff_host_screen[FF_CON_H][FF_CON_W];
+static int cur_x, cur_y;
+static int esc_state, esc_param[2], esc_n;
+
+static void con_clear(void){
+    memset(ff_host_screen, ' ', sizeof(ff_host_screen));
+    cur_x = cur_y = 0;
+}
+static void con_newrow(void){
+    cur_x = 0;
+    if (++cur_y >= FF_CON_H){
+        cur_y = FF_CON_H-1;
+        memmove(ff_host_screen[0], ff_host_screen[1], (FF_CON_H-1)*FF_CON_W);
+        memset(ff_host_screen[FF_CON_H-1], ' ', FF_CON_W);
+    }
+}
+static void con_escape(char c){
+    if (c>='0' && c<='9'){ esc_param[esc_n] = esc_param[esc_n]*10 + (c-'0'); return; }
+    if (c==';'){ if (esc_n<1) esc_n++; return; }
+    esc_state = 0;
+    switch(c){
+        case 'H': case 'f':
+            cur_y = esc_param[0]; cur_x = esc_param[1];
+            if (cur_y>=FF_CON_H) cur_y=FF_CON_H-1;
+            if (cur_x>FF_CON_W) cur_x=FF_CON_W;
+            break;
+        case 'J': if (esc_param[0]==2) con_clear(); break;
+        default: break;
+    }
+}
+
+int ff_host_putchar(int c){
+    if (esc_state==1){
+        if (c=='['){ esc_state=2; esc_param[0]=esc_param[1]=0; esc_n=0; } else esc_state=0;
+        return c;
+    }
+    if (esc_state==2){ con_escape((char)c); return c; }
+    switch(c){
+        case 0x1b: esc_state=1; break;
+        case '\n': con_newrow(); break;
+        case '\r': cur_x=0; break;
+        default:
+            if (cur_x>=FF_CON_W) con_newrow();
+            ff_host_screen[cur_y][cur_x++] = (char)c;
+            break;
+    }
+    return c;
+}
+
+int iprintf(const char* fmt, ...){
+    char buf[256];
+    va_list ap; va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    for(int i=0; buf[i]; i++) ff_host_putchar((unsigned char)buf[i]);
+    return n;
+}
+
+void consoleDemoInit(void){
+    SetMode(MODE_0 | BG0_ON);
+    con_clear();
+    esc_state = 0;
+}
@@ -0,0 +1,26 @@
+/*
+    Aggancio del build host: incluso con -include prima di main.c.
+    Il profiler di main.c (FF_PROFILE) misura con ff_host_now_ns() e passa
+    ogni campione anche a ff_bench_record(), che il runner aggrega.
+*/
+#ifndef FF_HOST_H
+#define FF_HOST_H
+
+#include <stdint.h>
+
+unsigned long long ff_host_now_ns(void);
+void ff_bench_record(int scope, unsigned long long ns);
+
+// Profiler (main.c): nome dello scope i, NULL oltre l'ultimo.
+const char* prof_scope_name(int i);
+
+// Log degli input (main.c): un uint32 per run, tasti<<16 | frame.
+void input_record(uint32_t* buf, uint32_t cap);
+void input_replay(const uint32_t* log, uint32_t n);
+uint32_t input_log_len(void);
+
+// Runner: chiamato a ogni VBlankIntrWait(), dopo l'avanzamento del frame.
+extern void (*ff_host_vblank_hook)(void);
+extern unsigned ff_host_frame;
+
+#endif
@@ -0,0 +1,29 @@
+/*
+    Shim host di libgba: le regioni di memoria del GBA sono array host,
+    cosi' le macro dei registri restano identiche a quelle di libgba.
+*/
+#ifndef _gba_base_h_
+#define _gba_base_h_
+
+#include "gba_types.h"
+
+extern u8 ff_host_io[0x400];
+extern u8 ff_host_pal[0x400];
+extern u8 ff_host_vram[0x18000];
+extern u8 ff_host_oam[0x400];
+extern u8 ff_host_sram[0x10000];
+
+#define REG_BASE ((uintptr_t)ff_host_io)
+#define PAL      ((uintptr_t)ff_host_pal)
+#define VRAM     ((uintptr_t)ff_host_vram)
+#define OAM_BASE ((uintptr_t)ff_host_oam)
+#define SRAM     ((uintptr_t)ff_host_sram)
+
+#define BIT(number) (1<<(number))
+
+#define IWRAM_CODE
+#define EWRAM_DATA
+#define EWRAM_BSS
+#define ALIGN(m) __attribute__((aligned(m)))
+
+#endif
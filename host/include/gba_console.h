@@ -0,0 +1,27 @@
+/*
+    Shim host di libgba: console testuale 30x20 emulata in memoria.
+    putchar() e iprintf() scrivono sulla griglia, non su stdout.
+*/
+#ifndef _gba_console_h_
+#define _gba_console_h_
+
+#include <stdio.h>
+#include "gba_base.h"
+
+#define FF_CON_W 30
+#define FF_CON_H 20
+
+extern char ff_host_screen[FF_CON_H][FF_CON_W];
+
+void consoleDemoInit(void);
+int  iprintf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+int  ff_host_putchar(int c);
+
+// Varianti intere di newlib (stdio.h del devkit): sul host bastano quelle libc.
+#define sniprintf  snprintf
+#define vsniprintf vsnprintf
+
+#undef putchar
+#define putchar(c) ff_host_putchar(c)
+
+#endif
@@ -0,0 +1,26 @@
+/*
+    Shim host di libgba: DMA. Sul host un registro non puo' contenere un
+    puntatore a 64 bit, quindi DMA3COPY() diventa una chiamata allo shim
+    con la stessa parola di controllo (modo | numero di unita').
+*/
+#ifndef _gba_dma_h_
+#define _gba_dma_h_
+
+#include "gba_base.h"
+
+#define DMA_ENABLE    (1u<<31)
+#define DMA_IMMEDIATE 0
+#define DMA_VBLANK    (1u<<28)
+#define DMA16         0
+#define DMA32         (1u<<26)
+#define DMA_SRC_INC   0
+#define DMA_DST_INC   0
+
+#define COPY16 (DMA_ENABLE | DMA_IMMEDIATE | DMA16)
+#define COPY32 (DMA_ENABLE | DMA_IMMEDIATE | DMA32)
+
+void ff_host_dma3(const void *source, void *dest, u32 mode);
+
+#define DMA3COPY(source, dest, mode) ff_host_dma3((source), (dest), (mode))
+
+#endif
@@ -0,0 +1,32 @@
+/*
+    Shim host di libgba: sprite. OAM e' un array host (ff_host_oam) con lo
+    stesso layout a 8 byte per voce dell'hardware.
+*/
+#ifndef _gba_sprites_h_
+#define _gba_sprites_h_
+
+#include "gba_base.h"
+
+typedef struct {
+    u16 attr0;
+    u16 attr1;
+    u16 attr2;
+    u16 dummy;
+} ALIGN(4) OBJATTR;
+
+#define OAM ((OBJATTR *)OAM_BASE)
+
+#define OBJ_Y(m) ((m)&0x00ff)
+#define ATTR0_NORMAL   (0<<8)
+#define ATTR0_DISABLED (2<<8)
+#define ATTR0_COLOR_16 (0<<13)
+#define ATTR0_SQUARE   (0<<14)
+
+#define OBJ_X(m) ((m)&0x01ff)
+#define ATTR1_SIZE_8   (0<<14)
+
+#define OBJ_CHAR(m)        ((m)&0x03ff)
+#define ATTR2_PRIORITY(n)  ((n)<<10)
+#define ATTR2_PALETTE(n)   ((n)<<12)
+
+#endif
@@ -0,0 +1,15 @@
+/*
+    Shim host di libgba: chiamate BIOS. VBlankIntrWait() chiude il frame
+    e passa il controllo al runner host (input, conteggio, uscita); i
+    decompressori leggono gli stessi formati LZ77/RLE del BIOS.
+*/
+#ifndef _gba_systemcalls_h_
+#define _gba_systemcalls_h_
+
+#include "gba_base.h"
+
+void VBlankIntrWait(void);
+void LZ77UnCompWram(const void *source, void *dest);
+void RLUnCompWram(const void *source, void *dest);
+
+#endif
@@ -0,0 +1,22 @@
+/*
+    Shim host di libgba: tipi base.
+*/
+#ifndef _gba_types_h_
+#define _gba_types_h_
+
+#include <stdint.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+
+typedef volatile u8  vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+typedef volatile s16 vs16;
+typedef volatile s32 vs32;
+
+#endif
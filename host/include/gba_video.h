@@ -0,0 +1,48 @@
+/*
+    Shim host di libgba: registri video.
+*/
+#ifndef _gba_video_h_
+#define _gba_video_h_
+
+#include "gba_base.h"
+
+#define REG_DISPCNT  *((vu16 *)(REG_BASE + 0x00))
+#define REG_DISPSTAT *((vu16 *)(REG_BASE + 0x04))
+#define REG_VCOUNT   *((vu16 *)(REG_BASE + 0x06))
+
+#define REG_BG0CNT   *((vu16 *)(REG_BASE + 0x08))
+#define REG_BG1CNT   *((vu16 *)(REG_BASE + 0x0a))
+#define REG_BG2CNT   *((vu16 *)(REG_BASE + 0x0c))
+#define REG_BG3CNT   *((vu16 *)(REG_BASE + 0x0e))
+#define REG_BG0HOFS  *((u16 *)(REG_BASE + 0x10))
+#define REG_BG0VOFS  *((u16 *)(REG_BASE + 0x12))
+#define REG_BG1HOFS  *((u16 *)(REG_BASE + 0x14))
+#define REG_BG1VOFS  *((u16 *)(REG_BASE + 0x16))
+
+#define BG_COLORS  ((u16 *)(PAL))
+#define BG_PALETTE BG_COLORS
+#define OBJ_COLORS ((u16 *)(PAL + 0x200))
+#define SPRITE_PALETTE OBJ_COLORS
+
+#define RGB5(r,g,b) ((r)|((g)<<5)|((b)<<10))
+
+#define MODE_0  0
+#define BG0_ON  (1<<8)
+#define BG1_ON  (1<<9)
+#define BG2_ON  (1<<10)
+#define BG3_ON  (1<<11)
+#define OBJ_ON  (1<<12)
+#define OBJ_1D_MAP (1<<6)
+
+#define SetMode(mode) REG_DISPCNT = (mode)
+
+#define BG_16_COLOR  (0<<7)
+#define BG_256_COLOR (1<<7)
+#define BG_SIZE_0    (0<<14)
+#define BG_PRIORITY(m) ((m))
+#define CHAR_BASE(m)   ((m) << 2)
+#define SCREEN_BASE(m) ((m) << 8)
+#define CHAR_BASE_BLOCK(m)   ((void *)(VRAM + ((m) << 14)))
+#define SCREEN_BASE_BLOCK(m) ((void *)(VRAM + ((m) << 11)))
+
+#endif
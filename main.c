@@ -9,49 +9,118 @@
 
 #include <gba_base.h>
 #include <gba_console.h>
+#include <gba_dma.h>
 #include <gba_interrupt.h>
 #include <gba_input.h>
+#include <gba_sprites.h>
 #include <gba_systemcalls.h>
+#include <gba_timers.h>
 #include <gba_video.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAP_W 80
-#define MAP_H 64
+#define MAP_W 1024          // mondo a chunk generati su richiesta (vedi "Mondo a chunk")
+#define MAP_H 1024
 #define VIEW_W 30
-#define VIEW_H 20
-
-// Tiles (caratteri)
-#define TILE_EMPTY '.'
-#define TILE_GRASS 'G'
-#define TILE_TREE  'Y'
-#define TILE_WALL  '#'
-#define TILE_WATER 'W'
-#define TILE_SAND  'S'
-#define TILE_BASE  '='
-#define TILE_TOWER 'T'
-#define TILE_FARM  'F'
-#define TILE_FIRE  'H'
-#define TILE_POST  'P'
-#define TILE_NPC   '@'
+#define VIEW_H 15
+
+// IWRAM (32 KB) tiene .data, .bss, il codice IRQ di libgba e lo stack, che a
+// iprintf serve largo: i buffer grandi o usati di rado stanno in EWRAM
+// (256 KB, bus a 16 bit) con EWRAM_BSS; in IWRAM restano cache dei chunk,
+// occupazione, schermo ombra e OAM ombra.
+
+// Tiles: ID a 4 bit (due per byte nei chunk); aspetto e comportamento
+// stanno in TILE_PROPS, una riga per tipo.
+typedef enum {
+    TILE_EMPTY=0, TILE_GRASS, TILE_TREE, TILE_WALL, TILE_WATER, TILE_SAND,
+    TILE_BASE, TILE_TOWER, TILE_FARM, TILE_FIRE, TILE_POST, TILE_COUNT
+} TileId;
+#define GLYPH_PLAYER 'P'
+#define GLYPH_NPC    '@'
+#define GLYPH_ENEMY  '&'
+
+// Profiler -------------------------------------------------------------------
+// Con -DFF_PROFILE, PROF(scope, call) misura la chiamata: sul GBA in cicli
+// con TM0+TM1 in cascata (contatore a 32 bit a 16.78 MHz), nel build host in
+// ns con clock_gettime. I campioni finiscono in un ring da PROF_RING voci da
+// cui l'overlay (menu START, giu') calcola min/avg/max per scope; un frame
+// che supera PROF_FRAME_TICKS conta come VBlank persa. Senza FF_PROFILE
+// PROF() e' la chiamata nuda e il resto non viene compilato.
+typedef enum {
+    PROF_VIEW=0, PROF_SPRITES, PROF_MINIMAP, PROF_HUD, PROF_GATHER, PROF_BATTLE, PROF_BUILD_MAP, PROF_FRAME, PROF_COUNT
+} ProfScope;
+
+#ifdef FF_PROFILE
+#define PROF_RING 256
+
+#ifdef FF_HOST
+#define PROF_UNIT "ns"
+#define PROF_FRAME_TICKS 16742706u          // 1/59.73 s
+static inline u32 prof_now(){ return (u32)ff_host_now_ns(); }
+#else
+#define PROF_UNIT "cyc"
+#define PROF_FRAME_TICKS 280896u            // 228 linee x 1232 cicli
+static inline u32 prof_now(){
+    u16 hi, lo;
+    do { hi=REG_TM1CNT_L; lo=REG_TM0CNT_L; } while (hi!=REG_TM1CNT_L);  // TM0 riparte tra le due letture
+    return (u32)hi<<16 | lo;
+}
+#endif
+
+static const char* const PROF_NAMES[PROF_COUNT] = {
+    "view", "sprites", "minimap", "hud", "gather", "battle", "buildmap", "frame",
+};
+static u8  prof_ring_scope[PROF_RING] EWRAM_BSS;
+static u32 prof_ring_ticks[PROF_RING] EWRAM_BSS;
+static u8  prof_head;                       // u8: avvolge da solo su PROF_RING
+static u16 prof_filled;                     // voci valide nel ring
+static u32 prof_missed;                     // VBlank perse dall'avvio
+static u8  prof_show;                       // overlay attivo
+static u8  prof_age;                        // frame dall'ultimo ricalcolo dell'overlay
+
+static void prof_init(){
+    REG_TM0CNT_H=0; REG_TM1CNT_H=0;
+    REG_TM0CNT_L=0; REG_TM1CNT_L=0;
+    REG_TM1CNT_H=TIMER_START|TIMER_COUNT;   // TM1 conta gli overflow di TM0
+    REG_TM0CNT_H=TIMER_START;               // TM0 a 1 ciclo per tick
+}
+
+static void prof_record(ProfScope id, u32 ticks){
+    prof_ring_scope[prof_head]=(u8)id; prof_ring_ticks[prof_head]=ticks; prof_head++;
+    if (prof_filled<PROF_RING) prof_filled++;
+    if (id==PROF_FRAME && ticks>PROF_FRAME_TICKS) prof_missed += ticks/PROF_FRAME_TICKS;
+#ifdef FF_HOST
+    ff_bench_record(id, ticks);
+#endif
+}
+
+// Per il runner host (host/bench.c).
+const char* prof_scope_name(int i){ return (i>=0 && i<PROF_COUNT) ? PROF_NAMES[i] : 0; }
+
+#define PROF(id, call) do{ u32 prof_t0_=prof_now(); call; prof_record((id), prof_now()-prof_t0_); }while(0)
+#else
+#define PROF(id, call) call
+#endif
 
 #define MAX_COMPANIONS 3
 #define MAX_MISSIONS   5
 #define MAX_NPC        6
 
 typedef enum { GS_WORLD=0, GS_BATTLE=1, GS_MSG=2, GS_MENU=3, GS_BOSS=4 } GameState;
-typedef enum { TYPE_NEUTRAL=0, TYPE_FIRE, TYPE_WATER, TYPE_GRASS, TYPE_ELEC } ElemType;
+typedef enum { TYPE_NEUTRAL=0, TYPE_FIRE, TYPE_WATER, TYPE_GRASS, TYPE_ELEC, TYPE_COUNT } ElemType;
+typedef enum { SP_FLAREPUP=0, SP_AQUADINE, SP_SPROUTLE, SP_VOLTBIT, SP_COUNT } SpeciesId;
+typedef enum { AB_RAPIDO=0, AB_CURA, AB_TENACE, AB_COUNT } AbilityId;
+typedef enum { BIOME_PRATO=0, BIOME_BOSCO, BIOME_DESERTO, BIOME_COUNT } Biome;
 
+// Record compatto: nome, tipo e dati fissi stanno in SPECIES[species].
 typedef struct {
-    const char* name;
-    ElemType type;
-    int max_hp;
-    int hp;
-    int atk;
-    int speed;
-    const char* ability;
-    int caught;
+    u8 species;         // SpeciesId
+    u8 ability;         // AbilityId
+    u8 atk, speed;
+    s16 max_hp, hp;
+    u8 caught;
 } Creature;
 
 typedef struct {
@@ -66,96 +135,68 @@ typedef struct {
     const char* name;
     int required_wood;
     int required_stone;
-    char tile_char;
+    u8 tile;
 } BuildDef;
 
+#define TF_PASS  1      // ci si puo' camminare
+#define TF_BUILD 2      // ci si puo' costruire sopra
+#define TF_AI_BLOCK 4   // i nemici notturni non ci passano (vedi flow_step)
+typedef enum { ACT_TALK=0, ACT_WALL, ACT_WATER, ACT_CHOP, ACT_FORAGE, ACT_POST, ACT_FARM, ACT_FIRE } TileAction;
+typedef struct {
+    char glyph;         // vista testo
+    char mini;          // minimappa
+    u8 flags;           // TF_*
+    u8 action;          // TileAction per A in try_gather_or_action
+    u8 encounter;       // % di incontro con ACT_FORAGE
+    u8 biome;           // Biome per la scelta della specie selvatica
+} TileProps;
+
+static const TileProps TILE_PROPS[TILE_COUNT] = {
+    [TILE_EMPTY]={'.','.', TF_PASS|TF_BUILD, ACT_TALK,    0, BIOME_PRATO},
+    [TILE_GRASS]={'G','g', TF_PASS|TF_BUILD, ACT_FORAGE, 18, BIOME_PRATO},
+    [TILE_TREE] ={'Y','y', TF_PASS,          ACT_CHOP,    0, BIOME_BOSCO},
+    [TILE_WALL] ={'#','#', 0,                ACT_WALL,    0, BIOME_PRATO},
+    [TILE_WATER]={'W','w', 0,                ACT_WATER,   0, BIOME_PRATO},
+    [TILE_SAND] ={'S','s', TF_PASS|TF_BUILD, ACT_FORAGE, 18, BIOME_DESERTO},
+    [TILE_BASE] ={'=','=', TF_PASS|TF_BUILD, ACT_TALK,    0, BIOME_PRATO},
+    [TILE_TOWER]={'T','t', TF_PASS|TF_AI_BLOCK, ACT_TALK,    0, BIOME_PRATO},
+    [TILE_FARM] ={'F','f', TF_PASS,          ACT_FARM,    0, BIOME_PRATO},
+    [TILE_FIRE] ={'H','h', TF_PASS,          ACT_FIRE,    0, BIOME_PRATO},
+    [TILE_POST] ={'P','p', TF_PASS,          ACT_POST,    0, BIOME_PRATO},
+};
+
+// Missioni e NPC: la parte fissa sta in ROM (MISSION_DEFS, NPC_DEFS da
+// assets.h), in RAM solo lo stato che cambia in partita.
+typedef struct {
+    u16 title, desc;            // ID di stringa
+} MissionDef;
+
 typedef struct {
-    const char* title;
-    const char* desc;
-    int completed;
-} Mission;
+    u16 x, y;
+    u8 gift_wood, gift_stone, gift_orb;
+    u16 name, talk;             // ID di stringa; talk e' tutta la conversazione
+} NpcDef;
 
 typedef struct {
     int x, y;
-    const char* name;
-    const char* lines[3];
-    int line_count;
     int gave_gift;
-    int gift_wood;
-    int gift_stone;
-    int gift_orb;
 } NPC;
 
-// SRAM SAVE --------------------------------------------------------------
-#define SRAM_BASE ((volatile unsigned char*)0x0E000000)
-#define SAVE_SIGNATURE "FFGE1"
-typedef struct {
-    char sig[6];
-    int px, py;
-    int steps;
-    int orbs, wood, stone;
-    int comp_count;
-    Creature comps[MAX_COMPANIONS];
-    int missions[MAX_MISSIONS];
-} SaveData;
-
-static void sram_write(const void* src, unsigned int len){
-    const unsigned char* s = (const unsigned char*)src;
-    volatile unsigned char* d = SRAM_BASE;
-    for(unsigned int i=0;i<len;i++) d[i] = s[i];
-}
-static void sram_read(void* dst, unsigned int len){
-    unsigned char* d = (unsigned char*)dst;
-    volatile unsigned char* s = SRAM_BASE;
-    for(unsigned int i=0;i<len;i++) d[i] = s[i];
-}
-static int save_game(Player* pl, Creature* comps, int comp_count, Mission* ms){
-    SaveData sv; memset(&sv, 0, sizeof(sv));
-    strncpy(sv.sig, SAVE_SIGNATURE, 6);
-    sv.px=pl->x; sv.py=pl->y; sv.steps=pl->steps;
-    sv.orbs=pl->orbs; sv.wood=pl->wood; sv.stone=pl->stone;
-    sv.comp_count=comp_count;
-    for(int i=0;i<comp_count && i<MAX_COMPANIONS;i++) sv.comps[i]=comps[i];
-    for(int i=0;i<MAX_MISSIONS;i++) sv.missions[i]=ms[i].completed;
-    sram_write(&sv, sizeof(sv));
-    return 1;
-}
-static int load_game(Player* pl, Creature* comps, int* comp_count, Mission* ms){
-    SaveData sv; sram_read(&sv, sizeof(sv));
-    if (strncmp(sv.sig, SAVE_SIGNATURE, 5)!=0) return 0;
-    pl->x=sv.px; pl->y=sv.py; pl->steps=sv.steps;
-    pl->orbs=sv.orbs; pl->wood=sv.wood; pl->stone=sv.stone;
-    *comp_count = (sv.comp_count>MAX_COMPANIONS?MAX_COMPANIONS:sv.comp_count);
-    for(int i=0;i<*comp_count;i++) comps[i]=sv.comps[i];
-    for(int i=0;i<MAX_MISSIONS;i++) ms[i].completed=sv.missions[i];
-    return 1;
-}
-
 // GLOBALS ----------------------------------------------------------------
-static char map_data[MAP_H][MAP_W+1];
 static Player player;
-static GameState gstate;
+static GameState gstate, gstate_next;     // gstate_next: applicato dallo scheduler a fine frame
 static Creature wild;
 static Creature boss;
 static Creature companions[MAX_COMPANIONS];
 static int companion_count=0;
 static int sel_build = 0;
 static int msg_timer=0;
-static int seed0=1;
 
 static NPC npcs[MAX_NPC];
 static int npc_count=0;
 
 // Cataloghi --------------------------------------------------------------
-static const char* elem_name(ElemType t){
-    switch(t){
-        case TYPE_FIRE: return "Fuoco";
-        case TYPE_WATER: return "Acqua";
-        case TYPE_GRASS: return "Erba";
-        case TYPE_ELEC: return "Elettro";
-        default: return "Neutro";
-    }
-}
+static const char* const ELEM_NAME[TYPE_COUNT] = { "Neutro", "Fuoco", "Acqua", "Erba", "Elettro" };
 
 static BuildDef BUILDINGS[] = {
     {"PostoLavoro", 10, 6, TILE_POST},
@@ -165,153 +206,1469 @@ static BuildDef BUILDINGS[] = {
 };
 static const int BUILD_COUNT = sizeof(BUILDINGS)/sizeof(BUILDINGS[0]);
 
-static Mission MISSIONS[MAX_MISSIONS] = {
-    {"Raccoglitore", "Raccogli 10 Legno e 6 Pietra.", 0},
-    {"Banco lavoro", "Costruisci un Posto di lavoro.", 0},
-    {"Difesa & Cibo","Costruisci 1 Torretta e 1 Farm.", 0},
-    {"Cacciatore",   "Cattura 2 creature diverse.", 0},
-    {"Miniboss",     "Sconfiggi il boss notturno nel Bosco.", 0},
-};
+// Zona di partenza, testi, NPC e missioni: generati da host/ffasset.c a partire da assets/.
+#include "assets.h"
+#if NPC_DEF_COUNT > MAX_NPC || MISSION_DEF_COUNT > MAX_MISSIONS
+#error "assets/ eccede MAX_NPC o MAX_MISSIONS (il salvataggio ha posti fissi)"
+#endif
+
+static u8 mission_done[MAX_MISSIONS];
+static int missions_done;       // quante mission_done[] sono a 1: chi le scrive lo aggiorna
+
+// Testi ------------------------------------------------------------------
+// Ogni frase del gioco sta in STR_DATA (assets.h), compressa a coppie di
+// byte, e si chiama per ID (S_*). str_getc() espande un codice alla volta
+// con una pila di STR_DEPTH byte: str() decodifica in uno di STR_BUFS buffer
+// a rotazione (piu' str() nella stessa iprintf non si pestano), str_print()
+// scrive sulla console senza buffer e le conversazioni si leggono una
+// pagina alla volta (talk_page).
+typedef struct { const u8* p; u8 sp; u8 stack[STR_DEPTH]; } StrReader;
+
+static void str_open(StrReader* r, int id){ r->p=&STR_DATA[STR_OFS[id]]; r->sp=0; }
+static int str_getc(StrReader* r){          // 0 a fine stringa
+    u8 c;
+    if (r->sp) c=r->stack[--r->sp];
+    else if (!(c=*r->p)) return 0;
+    else r->p++;
+    while (STR_PAIR[c][0]){ r->stack[r->sp++]=STR_PAIR[c][1]; c=STR_PAIR[c][0]; }
+    return c;
+}
+#define STR_BUFS 4
+static const char* str(int id){
+    static char buf[STR_BUFS][STR_LINE_MAX+1];
+    static u8 next;
+    char* b=buf[next++ & (STR_BUFS-1)];
+    StrReader r; str_open(&r, id);
+    int n=0, c;
+    while ((c=str_getc(&r)) && n<STR_LINE_MAX) b[n++]=(char)c;
+    b[n]='\0';
+    return b;
+}
+static void str_print(int id){
+    StrReader r; str_open(&r, id);
+    for(int c; (c=str_getc(&r)); ) putchar(c);
+}
+
+// Input ------------------------------------------------------------------
+// Il keypad si legge una volta sola per frame, in wait_vblank(): tutto il
+// codice del frame vede la stessa istantanea `input` (tenuti, fronti di
+// pressione e rilascio, autorepeat). Lo stream dei tasti si puo' registrare
+// in un log RLE e riprodurre: con lo stesso seme la partita si ripete.
+#define KEY_ALL      0x03FF
+#define KEY_DIRS     (KEY_UP|KEY_DOWN|KEY_LEFT|KEY_RIGHT)
+#define REPEAT_DELAY 3          // frame prima del primo autorepeat
+#define REPEAT_RATE  3          // frame tra due autorepeat
+
+typedef struct {
+    u16 held, pressed, released;
+    u16 repeat;                 // pressed + autorepeat delle frecce tenute
+    u32 frame;
+} InputSnap;
+
+static InputSnap input;
+static u8 repeat_timer;
+
+// Log: un u32 per run di frame con gli stessi tasti, tasti<<16 | frame (1..65535).
+typedef enum { IN_LIVE=0, IN_RECORD, IN_REPLAY } InputMode;
+static u8 in_mode;
+static u32* in_log;
+static u32 in_cap, in_len, in_pos, in_left;
+
+// Non statiche: il runner host (host/bench.c) registra e riproduce sessioni.
+void input_record(u32* buf, u32 cap){ in_log=buf; in_cap=cap; in_len=0; in_mode=IN_RECORD; }
+void input_replay(const u32* log, u32 n){ in_log=(u32*)log; in_len=n; in_pos=0; in_left=0; in_mode=IN_REPLAY; }
+u32 input_log_len(void){ return in_len; }
+
+static u16 input_source(){
+    if (in_mode==IN_REPLAY){
+        while (in_left==0){
+            if (in_pos>=in_len) return 0;           // log finito: nessun tasto
+            in_left = in_log[in_pos++] & 0xFFFF;
+        }
+        in_left--;
+        return (u16)(in_log[in_pos-1]>>16);
+    }
+    u16 keys = ~REG_KEYINPUT & KEY_ALL;
+    if (in_mode==IN_RECORD){
+        u32* last = in_len ? &in_log[in_len-1] : 0;
+        if (last && (*last>>16)==keys && (*last&0xFFFF)<0xFFFF) (*last)++;
+        else if (in_len<in_cap) in_log[in_len++] = (u32)keys<<16 | 1;
+        else in_mode=IN_LIVE;                        // log pieno: la registrazione si ferma qui
+    }
+    return keys;
+}
+
+static void input_poll(){
+    u16 k = input_source();
+    input.pressed  = k & ~input.held;
+    input.released = input.held & ~k;
+    input.repeat   = input.pressed;
+    // Solo le frecce: A, L o R premuti a passo tenuto non fermano il movimento.
+    u16 d = k & KEY_DIRS;
+    if (d!=(input.held & KEY_DIRS)) repeat_timer=REPEAT_DELAY;
+    else if (d && --repeat_timer==0){ input.repeat |= d; repeat_timer=REPEAT_RATE; }
+    input.held = k;
+    input.frame++;
+}
 
 // RNG & util -------------------------------------------------------------
-static inline void wait_vblank(){ VBlankIntrWait(); }
-static inline u16 key_down(){ scanKeys(); return keysDown(); }
-static inline u16 key_held(){ scanKeys(); return keysHeld(); }
+static inline void wait_vblank(){ VBlankIntrWait(); input_poll(); }
+static inline void set_state(GameState s){ gstate_next=s; }
+
+// Flussi xorshift32 indipendenti per sottosistema, tutti derivati da un seme
+// di sessione: con lo stesso seme (e lo stesso input) mondo e partita si
+// ripetono bit per bit, e un flusso non sposta gli altri. rng_range() riduce
+// con moltiplica-e-shift, senza divisioni (l'ARM7 non ha DIV hardware).
+typedef enum { RNG_WORLD=0, RNG_ENCOUNTER, RNG_BATTLE, RNG_LOOT, RNG_AI, RNG_COUNT } RngStream;
+static u32 rng_state[RNG_COUNT];
+static u32 session_seed;
 
-static void seed_rng(){
-    int s = REG_VCOUNT ^ (int)rand() ^ ((int)REG_VCOUNT<<16) ^ seed0;
-    srand(s);
+static u32 hash32(u32 x){
+    x ^= x>>16; x *= 0x7feb352du;
+    x ^= x>>15; x *= 0x846ca68bu;
+    x ^= x>>16; return x;
+}
+static void rng_seed(u32 seed){
+    session_seed = seed;
+    for(int i=0;i<RNG_COUNT;i++){
+        u32 st = hash32(seed + 0x9E3779B9u*(u32)(i+1));
+        rng_state[i] = st ? st : 1;
+    }
+}
+// xs_*: generatore su uno stato qualsiasi (anche fuori dai flussi, es. simulatore).
+static inline u32 xs_next(u32* s){
+    u32 x = *s;
+    x ^= x<<13; x ^= x>>17; x ^= x<<5;
+    return *s = x;
 }
-static int rand_range(int a, int b){
-    int r = rand() & 0x7fffffff; return a + (r % (b-a+1));
+// Intero uniforme in [a,b], con b-a < 65536.
+static inline int xs_range(u32* s, int a, int b){
+    return a + (int)(((xs_next(s)>>16) * (u32)(b-a+1)) >> 16);
 }
+static u32 rng_next(RngStream st){ return xs_next(&rng_state[st]); }
+static int rng_range(RngStream st, int a, int b){ return xs_range(&rng_state[st], a, b); }
 
 static int is_night(){ return (player.steps % 40) >= 30; }
 
-static void cls(){ iprintf("\x1b[2J\x1b[H"); }
-
 // Creature ----------------------------------------------------------------
-static Creature make_creature(const char* name, ElemType type, int hp, int atk, int spd, const char* ability){
-    Creature c; c.name=name; c.type=type; c.max_hp=hp; c.hp=hp; c.atk=atk; c.speed=spd; c.ability=ability; c.caught=0; return c;
-}
-static Creature random_wild(){
-    int r = rand_range(0,3);
-    switch(r){
-        case 0: return make_creature("Flarepup", TYPE_FIRE, 24+rand_range(0,6), 6, 6, "Rapido");
-        case 1: return make_creature("Aquadine", TYPE_WATER, 28+rand_range(0,6), 5, 5, "Cura");
-        case 2: return make_creature("Sproutle", TYPE_GRASS,26+rand_range(0,6), 5, 5, "Tenace");
-        default:return make_creature("Voltbit",  TYPE_ELEC, 22+rand_range(0,6), 7, 7, "Rapido");
-    }
-}
-static int type_multiplier(ElemType a, ElemType b){
-    if (a==TYPE_FIRE && b==TYPE_GRASS) return 2;
-    if (a==TYPE_WATER && b==TYPE_FIRE) return 2;
-    if (a==TYPE_GRASS && b==TYPE_WATER) return 2;
-    if (a==TYPE_ELEC && b==TYPE_WATER) return 2;
+// Specie, efficacia dei tipi e abilita' sono tabelle: aggiungere una specie
+// non tocca il codice di battaglia.
+typedef struct {
+    const char* name;
+    u8 type;                    // ElemType
+    u8 ability;                 // AbilityId
+    u8 base_hp, hp_var;         // HP = base_hp + [0, hp_var]
+    u8 atk, speed;
+    u8 weight[BIOME_COUNT];     // peso relativo negli incontri per bioma
+} SpeciesDef;
+
+static const SpeciesDef SPECIES[SP_COUNT] = {
+    //                 tipo        abilita'   hp  var atk spd  prato bosco deserto
+    [SP_FLAREPUP]={"Flarepup", TYPE_FIRE,  AB_RAPIDO, 24, 6, 6, 6, {2, 1, 4}},
+    [SP_AQUADINE]={"Aquadine", TYPE_WATER, AB_CURA,   28, 6, 5, 5, {3, 2, 1}},
+    [SP_SPROUTLE]={"Sproutle", TYPE_GRASS, AB_TENACE, 26, 6, 5, 5, {3, 4, 1}},
+    [SP_VOLTBIT] ={"Voltbit",  TYPE_ELEC,  AB_RAPIDO, 22, 6, 7, 7, {2, 1, 3}},
+};
+
+// Moltiplicatore di danno [attacco][difesa].
+static const u8 TYPE_MUL[TYPE_COUNT][TYPE_COUNT] = {
+    //              neu fuo acq erb ele
+    [TYPE_NEUTRAL]={ 1,  1,  1,  1,  1 },
+    [TYPE_FIRE]   ={ 1,  1,  1,  2,  1 },
+    [TYPE_WATER]  ={ 1,  2,  1,  1,  1 },
+    [TYPE_GRASS]  ={ 1,  1,  2,  1,  1 },
+    [TYPE_ELEC]   ={ 1,  1,  2,  1,  1 },
+};
+
+// Abilita': nome e gestori per evento, NULL = nessun effetto.
+typedef void (*AbilityFn)(Creature* c, u32* rng);
+typedef struct { const char* name; AbilityFn on_turn; } AbilityDef;
+
+static void ab_cura_turn(Creature* c, u32* rng){
+    if (xs_range(rng,0,99)<30){ c->hp += 2; if (c->hp>c->max_hp) c->hp=c->max_hp; }
+}
+static const AbilityDef ABILITIES[AB_COUNT] = {
+    [AB_RAPIDO]={"Rapido", NULL},
+    [AB_CURA]  ={"Cura",   ab_cura_turn},
+    [AB_TENACE]={"Tenace", NULL},
+};
+
+static inline const char* creature_name(const Creature* c){ return SPECIES[c->species].name; }
+static inline ElemType creature_type(const Creature* c){ return (ElemType)SPECIES[c->species].type; }
+
+static Creature make_creature(SpeciesId sp, int hp, int atk, int spd, AbilityId ab){
+    Creature c; c.species=sp; c.ability=ab; c.atk=atk; c.speed=spd; c.max_hp=hp; c.hp=hp; c.caught=0; return c;
+}
+static Creature spawn_creature(SpeciesId sp, u32* rng){
+    const SpeciesDef* d=&SPECIES[sp];
+    return make_creature(sp, d->base_hp+xs_range(rng,0,d->hp_var), d->atk, d->speed, (AbilityId)d->ability);
+}
+// Specie estratta secondo i pesi del bioma.
+static Creature random_wild(Biome b){
+    int total=0;
+    for(int i=0;i<SP_COUNT;i++) total+=SPECIES[i].weight[b];
+    int r = rng_range(RNG_ENCOUNTER,0,total-1);
+    int sp=0;
+    while(r>=SPECIES[sp].weight[b]){ r-=SPECIES[sp].weight[b]; sp++; }
+    return spawn_creature((SpeciesId)sp, &rng_state[RNG_ENCOUNTER]);
+}
+static inline int type_mul(ElemType a, ElemType b){ return TYPE_MUL[a][b]; }
+static void ability_tick(Creature* c, u32* rng){
+    AbilityFn f = ABILITIES[c->ability].on_turn;
+    if (f) f(c, rng);
+}
+
+// Occupazione entita' --------------------------------------------------------
+// Tabella hash (indirizzamento aperto) da tile a entita': draw_view, il dialogo
+// e le collisioni chiedono "chi sta qui?" in O(1) invece di scorrere npcs[].
+// Va aggiornata ogni volta che un'entita' viene piazzata o spostata.
+#define OCC_BITS  9
+#define OCC_CAP   (1<<OCC_BITS)   // slot; tenere il riempimento sotto meta'
+#define OCC_EMPTY 0xFFFFFFFFu
+#define OCC_NONE  0xFFFF
+#define ENT_NPC   (0<<12)         // tipo entita' nei 4 bit alti, indice nei 12 bassi
+#define ENT_ENEMY (1<<12)
+#define ENT_KIND(v)  ((v)&0xF000)
+#define ENT_INDEX(v) ((v)&0x0FFF)
+
+static u32 occ_key[OCC_CAP];
+static u16 occ_val[OCC_CAP];
+
+static inline u32 occ_pack(int x,int y){ return ((u32)y<<16) | (u32)x; }
+static inline unsigned occ_slot(u32 k){ return (k*2654435761u) >> (32-OCC_BITS); }
+
+static void occ_clear(){ memset(occ_key, 0xFF, sizeof(occ_key)); }
+static u16 occ_find(int x,int y){
+    u32 k=occ_pack(x,y);
+    for(unsigned i=occ_slot(k);; i=(i+1)&(OCC_CAP-1)){
+        if (occ_key[i]==k) return occ_val[i];
+        if (occ_key[i]==OCC_EMPTY) return OCC_NONE;
+    }
+}
+static void occ_add(int x,int y,u16 v){
+    u32 k=occ_pack(x,y);
+    unsigned i=occ_slot(k);
+    while(occ_key[i]!=OCC_EMPTY && occ_key[i]!=k) i=(i+1)&(OCC_CAP-1);
+    occ_key[i]=k; occ_val[i]=v;
+}
+static NPC* npc_at(int x,int y){
+    u16 v=occ_find(x,y);
+    return (v!=OCC_NONE && ENT_KIND(v)==ENT_NPC) ? &npcs[ENT_INDEX(v)] : NULL;
+}
+// Cancellazione con spostamento all'indietro: niente lapidi, le catene di
+// sondaggio restano corte anche con entita' che si muovono ogni frame.
+static void occ_remove(int x,int y){
+    u32 k=occ_pack(x,y);
+    unsigned i=occ_slot(k);
+    while(occ_key[i]!=k){
+        if (occ_key[i]==OCC_EMPTY) return;
+        i=(i+1)&(OCC_CAP-1);
+    }
+    for(unsigned j=i;;){
+        j=(j+1)&(OCC_CAP-1);
+        if (occ_key[j]==OCC_EMPTY) break;
+        unsigned h=occ_slot(occ_key[j]);
+        // j puo' occupare il buco i se i sta tra la sua casa h e j (ciclicamente)
+        if (((j-h)&(OCC_CAP-1)) >= ((j-i)&(OCC_CAP-1))){ occ_key[i]=occ_key[j]; occ_val[i]=occ_val[j]; i=j; }
+    }
+    occ_key[i]=OCC_EMPTY;
+}
+static void occ_move(int x0,int y0,int x1,int y1){
+    u16 v=occ_find(x0,y0);
+    occ_remove(x0,y0); occ_add(x1,y1,v);
+}
+static void npc_place(int i){ occ_add(npcs[i].x, npcs[i].y, ENT_NPC|i); }
+
+// Mondo a chunk ---------------------------------------------------------------
+// Il mondo MAP_W x MAP_H non sta in RAM: e' diviso in chunk CHUNK x CHUNK
+// generati in modo deterministico da world_seed e dalle coordinate del chunk.
+// Solo CHUNK_SLOTS chunk stanno in cache (LRU, ~come la vecchia mappa 80x64);
+// le modifiche del giocatore vivono in un registro sparso (mods[]) che viene
+// riapplicato quando un chunk modificato rientra in cache.
+#define CHUNK_SHIFT 4
+#define CHUNK       (1<<CHUNK_SHIFT)
+#define CHUNK_SLOTS 16          // la vista 30x20 tocca al massimo 3x3 chunk
+#define MOD_MAX     256
+
+typedef struct {
+    s16 cx, cy;                 // cx<0 = slot libero
+    u32 stamp;                  // ultimo uso, per l'LRU
+    u8 t[CHUNK*CHUNK/2];        // TileId a 4 bit, x pari nel nibble basso
+} Chunk;
+
+// Panoramica: un texel per chunk, 64x64 per tutto il mondo, con il TileId
+// che rappresenta il chunk e un bit "esplorato" (chunk generato almeno una
+// volta). Si calcola dal rumore dei biomi senza generare i chunk
+// (overview_build), poi si tocca un texel alla volta: esplorazione in
+// chunk_generate, costruzioni in map_set. I texel toccati aspettano in
+// ov_queue di essere ridisegnati da draw_overview(). I texel sono TileId a 4
+// bit, due per byte come nei chunk.
+#define OV_N     (MAP_W>>CHUNK_SHIFT)
+#define OV_QUEUE 16
+static u8  ov_tex[OV_N*OV_N/2] EWRAM_BSS;
+static u8  ov_seen[OV_N*OV_N/8] EWRAM_BSS;
+static u16 ov_queue[OV_QUEUE];
+static u8  ov_qn, ov_full=1;
+
+static inline u8 ov_get(int i){ u8 b=ov_tex[i>>1]; return (i&1) ? b>>4 : b&15; }
+static inline void ov_set(int i,u8 t){
+    u8* b=&ov_tex[i>>1];
+    *b = (i&1) ? (u8)((*b&0x0F)|(t<<4)) : (u8)((*b&0xF0)|t);
+}
+static void ov_touch(int i){
+    if (ov_qn<OV_QUEUE) ov_queue[ov_qn++]=(u16)i;
+    else ov_full=1;
+}
+
+static u32 world_seed;
+static Chunk chunks[CHUNK_SLOTS];
+static Chunk* chunk_last = &chunks[0];
+static u32 chunk_clock;
+static u32 mods[MOD_MAX] EWRAM_BSS;     // y<<18 | x<<8 | tile
+static int mod_count;
+
+static u32 world_hash(int x,int y,u32 salt){
+    return hash32(world_seed ^ salt ^ ((u32)x*0x9E3779B1u) ^ ((u32)y*0x85EBCA77u));
+}
+
+static inline u8 chunk_get(const Chunk* c,int x,int y){
+    int i=((y&(CHUNK-1))<<CHUNK_SHIFT)|(x&(CHUNK-1));
+    u8 b=c->t[i>>1];
+    return (i&1) ? b>>4 : b&15;
+}
+static inline void chunk_set(Chunk* c,int x,int y,u8 t){
+    int i=((y&(CHUNK-1))<<CHUNK_SHIFT)|(x&(CHUNK-1));
+    u8* b=&c->t[i>>1];
+    *b = (i&1) ? (u8)((*b&0x0F)|(t<<4)) : (u8)((*b&0xF0)|t);
+}
+
+// Rumore a reticolo 64x64 interpolato: per un chunk bastano i 4 angoli.
+#define BIOME_SHIFT 6
+// Rumore dei biomi nel punto (x,y): bilineare tra i 4 angoli della cella
+// del reticolo (n00..n11, in 0..255).
+static inline int biome_lerp(int n00,int n10,int n01,int n11,int x,int y){
+    int fx=x&((1<<BIOME_SHIFT)-1), fy=y&((1<<BIOME_SHIFT)-1);
+    int gx1=(1<<BIOME_SHIFT)-fx, gy1=(1<<BIOME_SHIFT)-fy;
+    return (n00*gx1*gy1 + n10*fx*gy1 + n01*gx1*fy + n11*fx*fy) >> (2*BIOME_SHIFT);
+}
+// Tile dal rumore n e dall'hash per cella h (0..1023, sceglie gli alberi).
+static inline u8 biome_tile(int n, u32 h){
+    if (n<48)  return TILE_WATER;
+    if (n<58)  return TILE_SAND;
+    if (n<150) return (h<40)?TILE_TREE:TILE_GRASS;
+    if (n<205) return (h<300)?TILE_TREE:TILE_GRASS;     // bosco
+    if (n<232) return TILE_SAND;                         // deserto
+    return TILE_WALL;                                    // monti
+}
+
+// La zona di partenza (START_CW x START_CH chunk) e' disegnata a mano in
+// assets/start.txt e sta in ROM gia' impacchettata e compressa: la
+// decomprime il BIOS direttamente nello slot. Il resto viene dal rumore.
+static void chunk_generate(Chunk* c){
+    if (c->cx<START_CW && c->cy<START_CH){
+        const u32* src=&START_BLOB[START_OFS[c->cy*START_CW+c->cx]];
+        if ((*src&0xF0)==0x30) RLUnCompWram(src, c->t);
+        else LZ77UnCompWram(src, c->t);
+    } else {
+        int ox=c->cx<<CHUNK_SHIFT, oy=c->cy<<CHUNK_SHIFT;
+        int gx=ox>>BIOME_SHIFT, gy=oy>>BIOME_SHIFT;
+        int n00=world_hash(gx,gy,1)&255,   n10=world_hash(gx+1,gy,1)&255;
+        int n01=world_hash(gx,gy+1,1)&255, n11=world_hash(gx+1,gy+1,1)&255;
+        for(int ly=0;ly<CHUNK;ly++){
+            for(int lx=0;lx<CHUNK;lx++){
+                int x=ox+lx, y=oy+ly;
+                u8 t=biome_tile(biome_lerp(n00,n10,n01,n11,x,y), world_hash(x,y,2) & 1023);
+                if (x==0||y==0||x==MAP_W-1||y==MAP_H-1) t=TILE_WALL;
+                chunk_set(c,lx,ly,t);
+            }
+        }
+    }
+    for(int i=0;i<mod_count;i++){
+        int x=(mods[i]>>8)&0x3FF, y=mods[i]>>18;
+        if ((x>>CHUNK_SHIFT)==c->cx && (y>>CHUNK_SHIFT)==c->cy)
+            chunk_set(c,x,y,(u8)(mods[i]&0xFF));
+    }
+    int i=c->cy*OV_N + c->cx;
+    if (!(ov_seen[i>>3] & (1<<(i&7)))){ ov_seen[i>>3] |= 1<<(i&7); ov_touch(i); }
+}
+
+static Chunk* chunk_for(int cx,int cy){
+    Chunk* c = chunk_last;
+    if (c->cx==cx && c->cy==cy) return c;
+    Chunk* lru = &chunks[0];
+    for(int i=0;i<CHUNK_SLOTS;i++){
+        c=&chunks[i];
+        if (c->cx==cx && c->cy==cy) goto hit;
+        if (c->cx<0 || (lru->cx>=0 && c->stamp<lru->stamp)) lru=c;
+    }
+    c=lru; c->cx=cx; c->cy=cy;
+    chunk_generate(c);
+hit:
+    c->stamp=++chunk_clock;
+    chunk_last=c;
+    return c;
+}
+
+static u8 map_get(int x,int y){
+    if ((unsigned)x>=MAP_W || (unsigned)y>=MAP_H) return TILE_WALL;
+    return chunk_get(chunk_for(x>>CHUNK_SHIFT, y>>CHUNK_SHIFT), x, y);
+}
+// Scrive un tile e lo annota nel registro delle modifiche. 0 se il registro e' pieno.
+static int map_set(int x,int y,u8 t){
+    u32 key=((u32)y<<18)|((u32)x<<8);
+    int i=0;
+    while(i<mod_count && (mods[i]&~0xFFu)!=key) i++;
+    if (i==mod_count){ if (mod_count==MOD_MAX) return 0; mod_count++; }
+    mods[i]=key|t;
+    chunk_set(chunk_for(x>>CHUNK_SHIFT, y>>CHUNK_SHIFT), x, y, t);
+    i=(y>>CHUNK_SHIFT)*OV_N + (x>>CHUNK_SHIFT);
+    ov_set(i,t); ov_touch(i);                   // le costruzioni si vedono nella panoramica
     return 1;
 }
-static void ability_tick(Creature* c){
-    if (strcmp(c->ability,"Cura")==0 && rand_range(0,99)<30){
-        c->hp += 2; if (c->hp>c->max_hp) c->hp=c->max_hp;
+
+// Svuota la cache: i chunk si rigenerano da world_seed + mods[] al prossimo accesso.
+static void chunk_cache_reset(){
+    for(int i=0;i<CHUNK_SLOTS;i++){ chunks[i].cx=-1; chunks[i].cy=-1; }
+    chunk_last=&chunks[0]; chunk_clock=0;
+}
+
+// Texel di ogni chunk: il tile al centro secondo il solo rumore (h=100: ne'
+// alberi radi nel prato ne' radure nel bosco), la zona di partenza da
+// START_OV; poi le costruzioni del registro. Non genera chunk.
+#define LAT_N ((MAP_W>>BIOME_SHIFT)+1)
+static void overview_build(){
+    static u8 lat[LAT_N][LAT_N] EWRAM_BSS;  // angoli del reticolo dei biomi, un hash ciascuno
+    for(int gy=0;gy<LAT_N;gy++) for(int gx=0;gx<LAT_N;gx++) lat[gy][gx]=world_hash(gx,gy,1)&255;
+    for(int cy=0;cy<OV_N;cy++){
+        int y=(cy<<CHUNK_SHIFT)+CHUNK/2, gy=y>>BIOME_SHIFT;
+        for(int cx=0;cx<OV_N;cx++){
+            int x=(cx<<CHUNK_SHIFT)+CHUNK/2, gx=x>>BIOME_SHIFT;
+            u8 t;
+            if (cx<START_CW && cy<START_CH) t=START_OV[cy*START_CW+cx];
+            else t=biome_tile(biome_lerp(lat[gy][gx], lat[gy][gx+1], lat[gy+1][gx], lat[gy+1][gx+1], x, y), 100);
+            ov_set(cy*OV_N+cx, t);
+        }
+    }
+    for(int i=0;i<mod_count;i++){
+        int x=(mods[i]>>8)&0x3FF, y=mods[i]>>18;
+        ov_set((y>>CHUNK_SHIFT)*OV_N + (x>>CHUNK_SHIFT), (u8)(mods[i]&0xFF));
+    }
+    ov_qn=0; ov_full=1;
+}
+
+// Edifici -------------------------------------------------------------------
+// Registro compatto delle costruzioni (tipo, posizione, stato) accanto a
+// mods[]: la mappa dice solo che tile c'e', il registro porta lo stato
+// (scorte, ricarica) e si interroga per raggio senza toccare i chunk.
+// Ogni edificio sta nella lista del suo secchio BKT x BKT celle: una query
+// con raggio < BKT visita al massimo 2x2 secchi. Non si salva: dopo un
+// caricamento si ricostruisce dal registro delle modifiche, con scorte vuote.
+#define MAX_BUILDINGS MOD_MAX           // ogni edificio e' una voce di mods[]
+#define BKT_SHIFT 5
+#define BKT_N     (MAP_W>>BKT_SHIFT)
+#define BLD_NONE  0xFFFF
+
+typedef struct {
+    s16 x, y;
+    u8 tile;            // TILE_TOWER..TILE_POST
+    u8 timer;           // tick alla prossima produzione / fine ricarica
+    u8 stock;           // prodotto in attesa di essere raccolto
+    u16 next;           // prossimo nello stesso secchio
+} Building;
+
+static Building blds[MAX_BUILDINGS] EWRAM_BSS;
+static int bld_count;
+static u16 bkt_head[BKT_N*BKT_N] EWRAM_BSS;
+
+static int is_building(u8 t){ return t>=TILE_TOWER && t<=TILE_POST; }
+
+static void bld_clear(){
+    bld_count=0;
+    memset(bkt_head, 0xFF, sizeof(bkt_head));
+}
+static void bld_add(int x,int y,u8 t){
+    if (bld_count==MAX_BUILDINGS) return;
+    u16* head=&bkt_head[(y>>BKT_SHIFT)*BKT_N + (x>>BKT_SHIFT)];
+    blds[bld_count]=(Building){ (s16)x, (s16)y, t, 0, 0, *head };
+    *head=(u16)bld_count++;
+}
+static void bld_rebuild(){
+    bld_clear();
+    for(int i=0;i<mod_count;i++){
+        u8 t=(u8)(mods[i]&0xFF);
+        if (is_building(t)) bld_add((mods[i]>>8)&0x3FF, mods[i]>>18, t);
     }
 }
 
-// Map/biomi -----------------------------------------------------------------
-static void put_rect(int x0,int y0,int x1,int y1,char ch){
-    for(int y=y0;y<=y1;y++) for(int x=x0;x<=x1;x++) map_data[y][x]=ch;
+// Primo edificio di tipo t entro r celle (Chebyshev) da (x,y); con ready
+// solo quelli senza ricarica in corso. NULL se non ce ne sono.
+static Building* bld_near(int x,int y,int r,u8 t,int ready){
+    int bx0=(x-r)>>BKT_SHIFT, bx1=(x+r)>>BKT_SHIFT, by0=(y-r)>>BKT_SHIFT, by1=(y+r)>>BKT_SHIFT;
+    if (bx0<0) bx0=0;
+    if (by0<0) by0=0;
+    if (bx1>=BKT_N) bx1=BKT_N-1;
+    if (by1>=BKT_N) by1=BKT_N-1;
+    for(int by=by0;by<=by1;by++) for(int bx=bx0;bx<=bx1;bx++){
+        for(u16 i=bkt_head[by*BKT_N+bx]; i!=BLD_NONE; i=blds[i].next){
+            Building* b=&blds[i];
+            if (b->tile!=t || (ready && b->timer)) continue;
+            int dx=b->x-x, dy=b->y-y;
+            if (dx>=-r && dx<=r && dy>=-r && dy<=r) return b;
+        }
+    }
+    return NULL;
 }
+
 static void build_map(){
-    // base: prato
-    for(int y=0;y<MAP_H;y++){
-        for(int x=0;x<MAP_W;x++){
-            char t = TILE_GRASS;
-            if (y==0||y==MAP_H-1||x==0||x==MAP_W-1) t=TILE_WALL;
-            map_data[y][x]=t;
-        }
-        map_data[y][MAP_W]='\0';
-    }
-    // bosco (alberi)
-    for(int i=0;i<300;i++){
-        int x=rand_range(2,MAP_W-3), y=rand_range(2,MAP_H-3);
-        if (rand_range(0,100)<60) map_data[y][x]=TILE_TREE;
-    }
-    // lago
-    put_rect(50,6,72,16,TILE_WATER);
-    // deserto
-    put_rect(8,36,30,56,TILE_SAND);
-    // monti / muri
-    for(int y=18;y<54;y++) map_data[y][44]=TILE_WALL;
-    for(int x=20;x<40;x++) map_data[28][x]=TILE_WALL;
-
-    // base iniziale
-    for(int y=2;y<8;y++) for(int x=2;x<10;x++) map_data[y][x] = TILE_BASE;
-
-    // NPC
-    npc_count=3;
-    npcs[0]=(NPC){6,6,"Saggio", {"Benvenuto, costruttore.","Raccogli legno e pietra.","Apri SELECT per craft."}, 3, 1,3,2,0};
-    npcs[1]=(NPC){22,26,"Cacciatrice", {"Di notte emergono nemici.","Una Torretta aiuta molto.","Occhio all'energia."}, 3, 1,0,2,1};
-    npcs[2]=(NPC){60,12,"Guardiano", {"Nel bosco a nord-est","si cela un Boss notturno.","Preparati bene."}, 3, 1,0,0,2};
+    world_seed = rng_next(RNG_WORLD);
+    chunk_cache_reset(); mod_count=0; bld_clear();
+    memset(ov_seen, 0, sizeof(ov_seen));
+    overview_build();
+
+    // NPC: posizione iniziale e testi da NPC_DEFS
+    npc_count=NPC_DEF_COUNT;
+    occ_clear();
+    for(int i=0;i<npc_count;i++){ npcs[i]=(NPC){NPC_DEFS[i].x, NPC_DEFS[i].y, 0}; npc_place(i); }
 
     player.x=4; player.y=4; player.steps=0; player.orbs=1; player.wood=8; player.stone=5;
 }
 
+// SRAM SAVE --------------------------------------------------------------
+// Due slot alternati: ogni salvataggio va nello slot che NON contiene l'ultimo
+// valido, scrivendo prima i dati e per ultima l'intestazione (seq + CRC32).
+// Se la scrittura si interrompe, il CRC non torna e al caricamento vince
+// l'altro slot. Di ogni blocco da SAVE_BLOCK byte si tiene in RAM il CRC
+// dell'ultima scrittura per slot: si riscrivono solo i blocchi cambiati,
+// quindi un salvataggio (anche automatico) costa pochi blocchi.
+// L'autosalvataggio e' un task di fondo: save_begin() fotografa lo stato e
+// save_step() scrive pochi blocchi per frame; save_game() fa tutto subito.
+// Ogni avvio crea un mondo nuovo, quindi l'autosalvataggio parte solo se la
+// sessione e' quella dell'ultimo salvataggio valido (salvata o caricata dal
+// giocatore) o se la SRAM non ne ha: non sovrascrive mai la partita vera con
+// un mondo appena generato.
+// Le creature sono salvate come ID di specie/abilita' (niente puntatori) e la
+// mappa come seme + registro delle modifiche del giocatore.
+#define SRAM_BASE    ((volatile unsigned char*)SRAM)
+#define SAVE_MAGIC   0x32454746u        // "FGE2"
+#define SAVE_VERSION 3
+#define SAVE_SLOT_SIZE 0x800
+#define SAVE_BLOCK   64
+#define AUTOSAVE_FRAMES (60*30)
+
+typedef struct { u32 magic; u16 version; u16 size; u32 seq; u32 crc; } SaveHeader;
+
+typedef struct {            // 8 byte, anche record del Box
+    u8 species, ability, atk, speed;
+    u16 hp, max_hp;
+} SaveCreature;
+
+static SaveCreature creature_pack(const Creature* c){
+    return (SaveCreature){ c->species, c->ability, c->atk, c->speed, (u16)c->hp, (u16)c->max_hp };
+}
+// 0 se il record non e' valido (SRAM vuota o rovinata).
+static int creature_unpack(const SaveCreature* sc, Creature* c){
+    if (sc->species>=SP_COUNT || sc->ability>=AB_COUNT) return 0;
+    *c=make_creature((SpeciesId)sc->species, sc->max_hp, sc->atk, sc->speed, (AbilityId)sc->ability);
+    c->hp=sc->hp; c->caught=1;
+    return 1;
+}
+
+typedef struct {
+    u32 world_seed, session_seed;
+    s32 px, py, steps;
+    s32 orbs, wood, stone;
+    u8 comp_count, npc_gifts, missions[MAX_MISSIONS];
+    u8 pad;
+    u16 mod_count;
+    SaveCreature comps[MAX_COMPANIONS];
+    u32 mods[MOD_MAX];
+    u8 explored[OV_N*OV_N/8];   // bitset della panoramica
+} SavePayload;
+
+#define SAVE_IMAGE  (sizeof(SaveHeader)+sizeof(SavePayload))
+#define SAVE_BLOCKS ((SAVE_IMAGE+SAVE_BLOCK-1)/SAVE_BLOCK)
+typedef char save_fits_slot[(SAVE_IMAGE<=SAVE_SLOT_SIZE)?1:-1];
+
+typedef struct { SaveHeader h; SavePayload p; u8 tail[SAVE_BLOCKS*SAVE_BLOCK-SAVE_IMAGE]; } SaveImage;
+
+static u32 slot_block_crc[2][SAVE_BLOCKS];  // CRC dell'ultimo contenuto noto per blocco
+static int save_scanned=0, save_slot=-1;    // slot dell'ultimo salvataggio valido
+static u32 slot_seed[2];                    // world_seed per slot, se slot_ok
+static u8  slot_ok[2];
+static u32 save_seq=0;
+static int autosave_timer=0;
+static SaveImage save_im EWRAM_BSS;         // immagine del salvataggio in corso (o del caricamento)
+static int save_block=-1;                   // prossimo blocco da scrivere, -1 = nessuno
+static int save_target;                     // slot del salvataggio in corso
+
+static void sram_write(unsigned off, const void* src, unsigned len){
+    const u8* s = (const u8*)src;
+    volatile u8* d = SRAM_BASE + off;
+    for(unsigned i=0;i<len;i++) d[i] = s[i];
+}
+static void sram_read(unsigned off, void* dst, unsigned len){
+    u8* d = (u8*)dst;
+    volatile u8* s = SRAM_BASE + off;
+    for(unsigned i=0;i<len;i++) d[i] = s[i];
+}
+
+// CRC-32 (IEEE) con tabella a nibble: 64 byte di ROM invece di 1 KB.
+static u32 crc32(u32 crc, const void* buf, unsigned len){
+    static const u32 T[16] = {
+        0x00000000,0x1db71064,0x3b6e20c8,0x26d930ac,0x76dc4190,0x6b6b51f4,0x4db26158,0x5005713c,
+        0xedb88320,0xf00f9344,0xd6d6a3e8,0xcb61b38c,0x9b64c2b0,0x86d3d2d4,0xa00ae278,0xbdbdf21c,
+    };
+    const u8* p = (const u8*)buf;
+    crc = ~crc;
+    while(len--){
+        crc ^= *p++;
+        crc = (crc>>4) ^ T[crc&15];
+        crc = (crc>>4) ^ T[crc&15];
+    }
+    return ~crc;
+}
+
+static int slot_valid(const SaveImage* im){
+    return im->h.magic==SAVE_MAGIC && im->h.version==SAVE_VERSION && im->h.size==sizeof(SavePayload)
+        && im->h.crc==crc32(0, &im->p, sizeof(SavePayload));
+}
+
+// Legge entrambi gli slot una volta: CRC per blocco e slot piu' recente.
+static void save_scan(SaveImage* im){
+    save_slot=-1; save_seq=0;
+    for(int s=0;s<2;s++){
+        sram_read(s*SAVE_SLOT_SIZE, im, sizeof(*im));
+        for(unsigned b=0;b<SAVE_BLOCKS;b++) slot_block_crc[s][b]=crc32(0, (u8*)im+b*SAVE_BLOCK, SAVE_BLOCK);
+        slot_ok[s]=(u8)slot_valid(im); slot_seed[s]=im->p.world_seed;
+        if (slot_ok[s] && (save_slot<0 || im->h.seq>save_seq)){ save_slot=s; save_seq=im->h.seq; }
+    }
+    save_scanned=1;
+}
+
+static void save_begin(){
+    if (!save_scanned) save_scan(&save_im);
+    memset(&save_im, 0, sizeof(save_im));
+    SavePayload* p = &save_im.p;
+    p->world_seed=world_seed; p->session_seed=session_seed;
+    p->px=player.x; p->py=player.y; p->steps=player.steps;
+    p->orbs=player.orbs; p->wood=player.wood; p->stone=player.stone;
+    p->comp_count=(u8)companion_count;
+    for(int i=0;i<companion_count;i++) p->comps[i]=creature_pack(&companions[i]);
+    for(int i=0;i<npc_count;i++) if (npcs[i].gave_gift) p->npc_gifts |= 1<<i;
+    for(int i=0;i<MAX_MISSIONS;i++) p->missions[i]=mission_done[i];
+    p->mod_count=(u16)mod_count;
+    memcpy(p->mods, mods, mod_count*sizeof(mods[0]));
+    memcpy(p->explored, ov_seen, sizeof(ov_seen));
+
+    save_target = save_slot==0 ? 1 : 0;
+    save_im.h=(SaveHeader){ SAVE_MAGIC, SAVE_VERSION, sizeof(SavePayload), save_seq+1, crc32(0, p, sizeof(*p)) };
+    save_block = SAVE_BLOCKS-1;
+    slot_ok[save_target]=0;                 // a meta' scrittura lo slot non vale
+    autosave_timer=0;
+}
+
+// Esamina al massimo max_blocks blocchi; ritorna quanti. Dati prima
+// (blocchi n..1), intestazione per ultima (blocco 0): solo allora lo slot vale.
+static int save_step(int max_blocks){
+    int n=0;
+    for(; save_block>=0 && n<max_blocks; save_block--, n++){
+        const u8* blk=(const u8*)&save_im + save_block*SAVE_BLOCK;
+        u32 c=crc32(0, blk, SAVE_BLOCK);
+        if (c==slot_block_crc[save_target][save_block]) continue;
+        sram_write(save_target*SAVE_SLOT_SIZE + save_block*SAVE_BLOCK, blk, SAVE_BLOCK);
+        slot_block_crc[save_target][save_block]=c;
+    }
+    if (save_block<0 && n>0){ save_slot=save_target; save_seq++; slot_ok[save_target]=1; slot_seed[save_target]=save_im.p.world_seed; }
+    return n;
+}
+
+// 1 se la sessione puo' scrivere da sola sulla SRAM (vedi sopra).
+static int save_is_ours(){
+    if (!save_scanned) save_scan(&save_im);
+    return save_slot<0 || slot_seed[save_slot]==world_seed;
+}
+
+static int save_game(){
+    save_begin();
+    save_step(SAVE_BLOCKS);
+    return 1;
+}
+
+static int load_game(){
+    save_block=-1;                          // un autosalvataggio a meta' e' ormai vecchio: save_im e' libera
+    save_scan(&save_im);
+    if (save_slot<0) return 0;
+    sram_read(save_slot*SAVE_SLOT_SIZE, &save_im, sizeof(save_im));
+    const SavePayload* p=&save_im.p;
+    if (p->comp_count>MAX_COMPANIONS || p->mod_count>MOD_MAX) return 0;
+    if ((unsigned)p->px>=MAP_W || (unsigned)p->py>=MAP_H) return 0;
+
+    world_seed=p->world_seed; session_seed=p->session_seed;
+    mod_count=p->mod_count;
+    memcpy(mods, p->mods, mod_count*sizeof(mods[0]));
+    memcpy(ov_seen, p->explored, sizeof(ov_seen));
+    chunk_cache_reset();
+    overview_build();
+    bld_rebuild();
+
+    player.x=p->px; player.y=p->py; player.steps=p->steps;
+    player.orbs=p->orbs; player.wood=p->wood; player.stone=p->stone;
+    companion_count=0;
+    for(int i=0;i<p->comp_count;i++)
+        if (creature_unpack(&p->comps[i], &companions[companion_count])) companion_count++;
+    for(int i=0;i<npc_count;i++) npcs[i].gave_gift = (p->npc_gifts>>i)&1;
+    missions_done=0;
+    for(int i=0;i<MAX_MISSIONS;i++){ mission_done[i]=p->missions[i]; missions_done+=mission_done[i]!=0; }
+    return 1;
+}
+
+// Box creature ---------------------------------------------------------------
+// Le catture oltre MAX_COMPANIONS finiscono nel Box: fino a BOX_CAP record
+// SaveCreature da 8 byte in SRAM dopo i due slot, preceduti da
+// un'intestazione con il mondo (world_seed) a cui appartengono e il numero
+// di record. In RAM resta solo l'indice: la specie di ogni record (1 byte,
+// per filtri e ordinamento) e la vista corrente; la schermata legge da SRAM
+// le sole BOX_PAGE righe della pagina mostrata.
+// Il Box e' di un solo mondo e segue i salvataggi: ogni deposito, prelievo o
+// scambio scrive i record e subito dopo fa save_game(), cosi' squadra e Box
+// dell'ultimo salvataggio combaciano (ricaricare non duplica ne' perde
+// creature). Per questo si usa solo da una sessione che possiede la SRAM
+// (save_is_ours()). Il Box di un altro mondo resta suo finche' uno slot
+// valido contiene quel mondo; quando nessuno lo contiene piu' (non si
+// potrebbe piu' caricare) il mondo corrente lo riprende vuoto.
+#define BOX_BASE   (2*SAVE_SLOT_SIZE)
+#define BOX_MAGIC  0x58424746u          // "FGBX"
+#define BOX_CAP    512
+#define BOX_PAGE   10
+#define BOX_REC(i) (BOX_BASE + sizeof(BoxHeader) + (unsigned)(i)*sizeof(SaveCreature))
+
+typedef struct { u32 magic; u32 owner; u16 count; u16 pad; } BoxHeader;
+typedef enum { BOX_OK=0, BOX_UNSAVED, BOX_FOREIGN } BoxAccess;
+typedef char box_fits_sram[(BOX_REC(BOX_CAP)<=0x10000)?1:-1];
+
+static u8  box_species[BOX_CAP] EWRAM_BSS;  // indice: specie di ogni record
+static u16 box_view[BOX_CAP] EWRAM_BSS;     // record che passano il filtro, nell'ordine mostrato
+static int box_count, box_view_n;
+static u32 box_owner;
+static u8  box_ready;
+static s8  box_filter=-1;               // ElemType mostrato, -1 = tutti
+static u8  box_by_species;              // ordine: 0 di cattura, 1 per specie
+
+static void box_write_header(){
+    BoxHeader h={ BOX_MAGIC, world_seed, (u16)box_count, 0 };
+    sram_write(BOX_BASE, &h, sizeof(h));
+}
+// Ricostruisce l'indice del mondo corrente: un byte letto per record.
+// Un Box senza padrone caricabile parte vuoto; l'intestazione cambia padrone
+// solo al primo deposito.
+static BoxAccess box_open(){
+    BoxHeader h;
+    sram_read(BOX_BASE, &h, sizeof(h));
+    int valid = h.magic==BOX_MAGIC && h.count<=BOX_CAP;
+    if (valid && h.owner!=world_seed)
+        for(int s=0;s<2;s++) if (slot_ok[s] && slot_seed[s]==h.owner) return BOX_FOREIGN;
+    box_count = (valid && h.owner==world_seed) ? h.count : 0;
+    for(int i=0;i<box_count;i++) sram_read(BOX_REC(i), &box_species[i], 1);
+    box_owner=world_seed; box_ready=1;
+    return BOX_OK;
+}
+// Nuova partita o caricamento cambiano world_seed: l'indice va rifatto.
+static BoxAccess box_sync(){
+    if (!save_is_ours()) return BOX_UNSAVED;
+    if (box_ready && box_owner==world_seed) return BOX_OK;
+    box_ready=0;
+    return box_open();
+}
+
+// Vista dal solo indice: per specie e' un ordinamento a secchi, una passata
+// per specie, senza leggere SRAM.
+static void box_build_view(){
+    box_view_n=0;
+    for(int sp=0; sp<(box_by_species?SP_COUNT:1); sp++){
+        for(int i=0;i<box_count;i++){
+            u8 s=box_species[i];
+            if (s>=SP_COUNT || (box_by_species && s!=sp)) continue;
+            if (box_filter>=0 && SPECIES[s].type!=box_filter) continue;
+            box_view[box_view_n++]=(u16)i;
+        }
+    }
+}
+
+// Ritorna l'ID del messaggio per il giocatore: S_BOX_IN se la creatura e'
+// entrata (argomenti: nome, box_count, BOX_CAP), altrimenti perche' no (nome).
+static int box_deposit(const Creature* c){
+    BoxAccess a=box_sync();
+    if (a!=BOX_OK) return a==BOX_UNSAVED ? S_BOX_UNSAVED : S_BOX_FOREIGN;
+    if (box_count==BOX_CAP) return S_BOX_FULL;
+    SaveCreature r=creature_pack(c);
+    sram_write(BOX_REC(box_count), &r, sizeof(r));
+    box_species[box_count++]=c->species;
+    box_write_header();                 // per ultima: un'interruzione perde solo il record nuovo
+    save_game();
+    return S_BOX_IN;
+}
+static int box_read(int rec, Creature* c){
+    SaveCreature r;
+    sram_read(BOX_REC(rec), &r, sizeof(r));
+    return creature_unpack(&r, c);
+}
+// Toglie il record rec: l'ultimo prende il suo posto.
+static void box_remove(int rec){
+    int last=box_count-1;
+    if (rec!=last){
+        SaveCreature r;
+        sram_read(BOX_REC(last), &r, sizeof(r));
+        sram_write(BOX_REC(rec), &r, sizeof(r));
+        box_species[rec]=box_species[last];
+    }
+    box_count=last;
+    box_write_header();
+}
+static void box_replace(int rec, const Creature* c){
+    SaveCreature r=creature_pack(c);
+    sram_write(BOX_REC(rec), &r, sizeof(r));
+    box_species[rec]=c->species;
+}
+
 // Rendering ------------------------------------------------------------------
+// Lo schermo (console 30x20) ha una copia ombra di cio' che mostra: scr_put()
+// scrive solo le celle che cambiano. La vista si ricompone intera solo quando
+// la camera si sposta, altrimenti solo le celle segnate con view_mark()
+// (costruzioni, raccolta) o view_mark_cell() (entita' che si muovono; con il
+// renderer BG le entita' sono sprite e non segnano nulla). Minimappa e HUD si
+// ridisegnano solo se cambia quello che mostrano, quindi un frame fermo non
+// scrive nulla.
+#define SCR_W 30
+#define SCR_H 20
+#define MM_X  18            // minimappa 12x12 sopra la vista
+#define MM_Y  1
+#define MM_N  12
+#define ROW_STATUS (VIEW_H)
+#define ROW_COMP   (VIEW_H+1)
+#define ROW_HUD    (VIEW_H+2)
+#define ROW_MSG    (VIEW_H+3) // 2 righe
+#define MAX_DIRTY  32
+#define RENDER_TEXT 0
+#define RENDER_BG   1
+#ifndef RENDER_DEFAULT
+#define RENDER_DEFAULT RENDER_BG
+#endif
+
+static char scr_shadow[SCR_H][SCR_W];
+static int con_x=-1, con_y=-1;          // cursore console, -1 = ignoto
+static int view_full=1, view_cx=-1, view_cy=-1;
+static int dirty_x[MAX_DIRTY], dirty_y[MAX_DIRTY], dirty_n=0;
+static int mm_full=1, mm_sx=-1, mm_sy=-1;
+static int hud_full=1;
+static int render_mode = RENDER_DEFAULT;
+static char msg_text[2*SCR_W+1];
+static int msg_dirty=0;
+
+static void cls(){
+    iprintf("\x1b[2J\x1b[H");
+    REG_DISPCNT &= ~(BG1_ON|BG2_ON|OBJ_ON);     // mondo, panoramica e sprite tornano al prossimo draw
+    memset(scr_shadow, ' ', sizeof(scr_shadow));
+    con_x=0; con_y=0;
+    view_full=1; mm_full=1; hud_full=1; msg_dirty=1; dirty_n=0;
+}
+
+// Cifre decimali di n scritte all'indietro da end; ritorna la prima.
+// Niente divisioni (il GBA non ha l'istruzione): (n*0xCCCD)>>19 == n/10
+// per n<43699, e chi chiama resta sotto (coordinate, valori della HUD).
+static char* fmt_u(char* end, u32 n){
+    do { u32 q=(n*0xCCCDu)>>19; *--end=(char)('0'+n-q*10); n=q; } while(n);
+    return end;
+}
+static void put_dec2(int n){ char b[2], *p=fmt_u(b+2, (u32)n); while(p<b+2) putchar(*p++); }
+static void con_goto(int x,int y){
+    if (x==con_x && y==con_y) return;
+    putchar(0x1b); putchar('['); put_dec2(y); putchar(';'); put_dec2(x); putchar('H');
+    con_x=x; con_y=y;
+}
+static void scr_put(int x,int y,char ch){
+    if (scr_shadow[y][x]==ch) return;
+    con_goto(x,y); putchar(ch); scr_shadow[y][x]=ch;
+    con_x = (x+1<SCR_W) ? x+1 : -1;   // a fine riga la console va a capo da sola
+}
+// Testo su w celle a partire da (x,y), riempito di spazi; prosegue sulla riga sotto.
+static void scr_text(int x,int y,int w,const char* s){
+    for(int i=0;i<w;i++){
+        char c = *s ? *s++ : ' ';
+        scr_put(x, y, c);
+        if (++x==SCR_W){ x=0; y++; }    // a capo senza divisioni
+    }
+}
+
+static void dirty_add(int mx,int my){
+    if (dirty_n<MAX_DIRTY){ dirty_x[dirty_n]=mx; dirty_y[dirty_n]=my; dirty_n++; }
+    else view_full=1;
+}
+static void mm_mark(int mx,int my){
+    if (mx>=mm_sx && mx<mm_sx+MM_N && my>=mm_sy && my<mm_sy+MM_N) mm_full=1;
+}
+// Solo la vista e solo col renderer a testo: per le entita', che sul BG sono sprite.
+static void view_mark_cell(int mx,int my){ if (render_mode==RENDER_TEXT) dirty_add(mx,my); }
+static void view_mark(int mx,int my){ dirty_add(mx,my); mm_mark(mx,my); }
+
+static void show_msg(int frames, const char* fmt, ...){
+    va_list ap; va_start(ap, fmt);
+    vsniprintf(msg_text, sizeof(msg_text), fmt, ap);
+    va_end(ap);
+    msg_timer=frames; msg_dirty=1;
+}
+static void tick_msg(){
+    if (msg_timer>0 && --msg_timer==0){ msg_text[0]='\0'; msg_dirty=1; }
+}
+
+static char view_glyph(int mx,int my){
+    if (mx==player.x && my==player.y) return GLYPH_PLAYER;
+    u16 v=occ_find(mx,my);
+    if (v!=OCC_NONE) return ENT_KIND(v)==ENT_ENEMY ? GLYPH_ENEMY : GLYPH_NPC;
+    return TILE_PROPS[map_get(mx,my)].glyph;
+}
+static int under_minimap(int x,int y){ return x>=MM_X && x<MM_X+MM_N && y>=MM_Y && y<MM_Y+MM_N; }
+
+// Renderer BG ----------------------------------------------------------------
+// Alternativa alla console per il mondo: i tile stanno su BG1 in una mappa
+// 32x32 usata ad anello, la camera si sposta con REG_BG1HOFS/VOFS e a ogni
+// passo si scrivono solo le colonne/righe che entrano nello schermo.
+// La console (BG0) resta sopra per minimappa, HUD e schermate modali.
+// Giocatore, NPC e nemici non stanno su BG1: sono sprite (vedi "Sprite").
+#define BGW_CHAR   1    // charblock dei tile del mondo (la console usa lo 0)
+#define BGW_SCREEN 30   // screenblock della mappa
+#define BGW_PAL    1    // banco palette
+#define OV_SCREEN  29   // screenblock della panoramica (BG2)
+#define OV_TILE0   16   // 64 tile 8x8 della panoramica, dopo quelli del mondo
+#define OV_BLANK   15   // tile trasparente per il resto di BG2
+#define OV_COL     20   // angolo della panoramica in celle, dentro l'area minimappa
+#define OV_ROW     3
+
+// I tile BG del terreno hanno lo stesso indice del TileId; quelli delle
+// entita' servono alla panoramica e, copiati nel charblock OBJ, agli sprite.
+enum { BGT_NPC=TILE_COUNT, BGT_PLAYER, BGT_ENEMY, BGT_COUNT };
+
+// Tile 8x8: '.' colore base, 'x' colore dettaglio (indici nel banco BGW_PAL);
+// ov e' il colore del tile nella panoramica.
+typedef struct { u8 base, detail, ov; const char* art; } BgTileArt;
+typedef char bg_tiles_fit[(BGT_COUNT<=OV_BLANK && OV_BLANK<OV_TILE0)?1:-1];
+static const BgTileArt BG_ART[BGT_COUNT] = {
+    [TILE_EMPTY] ={14,14,14,"................................................................"},
+    [TILE_GRASS] ={ 1, 2, 1,".........x....x.....x.......x......x...x.....x........x........."},
+    [TILE_TREE]  ={ 1, 2, 2,"...xx.....xxxx...xxxxxx.xxxxxxxx.xxxxxx....xx......xx.....xxxx.."},
+    [TILE_WALL]  ={ 4, 5, 4,"xxxxxxxx...x........x...xxxxxxxxx.......x.......xxxxxxxx...x...."},
+    [TILE_WATER] ={ 6, 7, 6,"..........xx..xx.x..xx..................xx..xx.x..xx............"},
+    [TILE_SAND]  ={ 8, 9, 8,"......x...x...........x.....x.......x.......x.....x...........x."},
+    [TILE_BASE]  ={10, 3,10,"x.x.x.x..x.x.x.xx.x.x.x..x.x.x.xx.x.x.x..x.x.x.xx.x.x.x..x.x.x.x"},
+    [TILE_TOWER] ={ 1, 5,12,".x.xx.x..xxxxxx...xxxx....xxxx....xxxx....xxxx...xxxxxx.xxxxxxxx"},
+    [TILE_FARM]  ={ 3, 2, 3,"........xxxxxxxx........xxxxxxxx........xxxxxxxx........xxxxxxxx"},
+    [TILE_FIRE]  ={ 1,13,13,"....x......xx.....xxx....xxxxx...xxxxx...xxxxxx..xxxxxx...xxxx.."},
+    [TILE_POST]  ={ 1, 3,10,"........xxxxxxxxxxxxxxxx.x....x..x....x..x....x..x....x........."},
+    [BGT_NPC]    ={ 1,15,15,"...xx......xx....xxxxxx..x.xx.x....xx.....x..x....x..x...xx..xx."},
+    [BGT_PLAYER] ={ 1,11,11,"...xx......xx....xxxxxx..x.xx.x....xx.....x..x....x..x...xx..xx."},
+    [BGT_ENEMY]  ={ 1,14,14,"..x..x...xxxxxx.xx.xx.xxxxxxxxxx.xxxxxx..x.xx.x.x..xx..x........"},
+};
+static const u16 BG_PAL_COLORS[16] = {
+    0, RGB5(6,20,6), RGB5(2,11,3), RGB5(14,9,4), RGB5(17,17,18), RGB5(9,9,10),
+    RGB5(4,10,26), RGB5(16,22,31), RGB5(27,25,14), RGB5(22,19,9), RGB5(25,21,15),
+    RGB5(28,4,4), RGB5(31,31,31), RGB5(31,18,2), RGB5(1,1,2), RGB5(20,8,24),
+};
+
+static u16* const bgw_map = (u16*)SCREEN_BASE_BLOCK(BGW_SCREEN);
+static int bg_cx=-1, bg_cy=-1;      // camera del contenuto dell'anello, -1 = da riempire
+
+static void bg_init(){
+    u32* dst = (u32*)CHAR_BASE_BLOCK(BGW_CHAR);
+    for(int t=0;t<BGT_COUNT;t++){
+        const BgTileArt* a = &BG_ART[t];
+        for(int r=0;r<8;r++){
+            u32 row=0;
+            for(int c=0;c<8;c++) row |= (u32)(a->art[r*8+c]=='x' ? a->detail : a->base) << (c*4);
+            *dst++ = row;
+        }
+    }
+    for(int i=0;i<16;i++) BG_COLORS[BGW_PAL*16+i] = BG_PAL_COLORS[i];
+    REG_BG1CNT = CHAR_BASE(BGW_CHAR) | SCREEN_BASE(BGW_SCREEN) | BG_16_COLOR | BG_SIZE_0 | BG_PRIORITY(1);
+
+    // Panoramica su BG2: 8x8 tile (64x64 pixel, un pixel per chunk), il resto trasparente.
+    memset((u8*)CHAR_BASE_BLOCK(BGW_CHAR) + OV_BLANK*32, 0, 32);
+    u16* ovm = (u16*)SCREEN_BASE_BLOCK(OV_SCREEN);
+    for(int i=0;i<32*32;i++) ovm[i] = (BGW_PAL<<12) | OV_BLANK;
+    for(int ty=0;ty<OV_N/8;ty++)
+        for(int tx=0;tx<OV_N/8;tx++) ovm[(OV_ROW+ty)*32 + OV_COL+tx] = (BGW_PAL<<12) | (OV_TILE0 + ty*(OV_N/8) + tx);
+    REG_BG2CNT = CHAR_BASE(BGW_CHAR) | SCREEN_BASE(OV_SCREEN) | BG_16_COLOR | BG_SIZE_0 | BG_PRIORITY(0);
+}
+
+static u16 bg_tile_at(int mx,int my){
+    if (mx<0 || mx>=MAP_W || my<0 || my>=MAP_H) return TILE_EMPTY;
+    return map_get(mx,my);
+}
+// Area che BG1 mostra dalla camera (vx,vy): tutto lo schermo, anche le righe
+// sotto la vista coperte in parte dalla HUD. Vale per i tile e per gli sprite.
+static int bg_visible(int mx,int my,int vx,int vy){
+    return mx>=vx && mx<vx+SCR_W && my>=vy && my<vy+SCR_H;
+}
+static void bg_put(int mx,int my){
+    bgw_map[(my&31)*32 + (mx&31)] = (BGW_PAL<<12) | bg_tile_at(mx,my);
+}
+static void bg_fill(int x0,int x1,int y0,int y1){   // [x0,x1) x [y0,y1)
+    for(int y=y0;y<y1;y++) for(int x=x0;x<x1;x++) bg_put(x,y);
+}
+// Porta l'anello sulla camera (vx,vy) scrivendo solo le strisce nuove.
+static void bg_scroll(int vx,int vy){
+    int dx=vx-bg_cx, dy=vy-bg_cy;
+    if (bg_cx<0 || dx>=SCR_W || -dx>=SCR_W || dy>=SCR_H || -dy>=SCR_H){
+        bg_fill(vx, vx+SCR_W, vy, vy+SCR_H);
+    } else {
+        if (dx>0) bg_fill(bg_cx+SCR_W, vx+SCR_W, vy, vy+SCR_H);
+        if (dx<0) bg_fill(vx, bg_cx, vy, vy+SCR_H);
+        if (dy>0) bg_fill(vx, vx+SCR_W, bg_cy+SCR_H, vy+SCR_H);
+        if (dy<0) bg_fill(vx, vx+SCR_W, vy, bg_cy);
+    }
+    REG_BG1HOFS = vx*8; REG_BG1VOFS = vy*8;
+    bg_cx=vx; bg_cy=vy;
+}
+static void draw_view_bg(int vx,int vy){
+    if (view_full){ bg_cx=-1; view_full=0; }
+    if (vx!=bg_cx || vy!=bg_cy) bg_scroll(vx,vy);
+    for(int i=0;i<dirty_n;i++) if (bg_visible(dirty_x[i], dirty_y[i], vx, vy)) bg_put(dirty_x[i], dirty_y[i]);
+    dirty_n=0;
+    REG_DISPCNT |= BG1_ON;
+}
+
+// Angolo della vista in celle: il giocatore al centro, fermo ai bordi della mappa.
+static void view_camera(int* vx,int* vy){
+    *vx = player.x - VIEW_W/2; if (*vx<0) *vx=0; if (*vx>MAP_W-VIEW_W) *vx=MAP_W-VIEW_W;
+    *vy = player.y - VIEW_H/2; if (*vy<0) *vy=0; if (*vy>MAP_H-VIEW_H) *vy=MAP_H-VIEW_H;
+}
+
 static void draw_view(){
-    int vx = player.x - VIEW_W/2; if (vx<0) vx=0; if (vx>MAP_W-VIEW_W) vx=MAP_W-VIEW_W;
-    int vy = player.y - VIEW_H/2; if (vy<0) vy=0; if (vy>MAP_H-VIEW_H) vy=MAP_H-VIEW_H;
-
-    iprintf("\x1b[H");
-    for(int y=0;y<VIEW_H;y++){
-        for(int x=0;x<VIEW_W;x++){
-            int mx=vx+x, my=vy+y;
-            char ch = map_data[my][mx];
-            if (mx==player.x && my==player.y) putchar('P');
-            else {
-                int nearNpc=0;
-                for(int i=0;i<npc_count;i++) if (npcs[i].x==mx && npcs[i].y==my) nearNpc=1;
-                if (nearNpc) putchar(TILE_NPC); else putchar(ch);
-            }
+    int vx, vy; view_camera(&vx, &vy);
+
+    if (render_mode==RENDER_BG){ draw_view_bg(vx,vy); return; }
+    if (vx!=view_cx || vy!=view_cy) view_full=1;
+    if (view_full){
+        for(int y=0;y<VIEW_H;y++)
+            for(int x=0;x<VIEW_W;x++)
+                if (!under_minimap(x,y)) scr_put(x, y, view_glyph(vx+x, vy+y));
+        view_full=0; view_cx=vx; view_cy=vy;
+    } else {
+        for(int i=0;i<dirty_n;i++){
+            int x=dirty_x[i]-vx, y=dirty_y[i]-vy;
+            if (x>=0 && x<VIEW_W && y>=0 && y<VIEW_H && !under_minimap(x,y))
+                scr_put(x, y, view_glyph(dirty_x[i], dirty_y[i]));
         }
-        putchar('\n');
     }
-    iprintf("Legno:%d Pietra:%d Sfere:%d  %s  Sel:%s  \n",
-        player.wood, player.stone, player.orbs, is_night()?"Notte":"Giorno", "Edificio");
-    iprintf("Compagni:%d  Missioni:START  Craft:SELECT  L+A Costruisci  R+A Cattura  \n", companion_count);
+    dirty_n=0;
+}
+
+// Panoramica (solo renderer BG) ----------------------------------------------
+// Un pixel per chunk nei tile OV_TILE0..: cambiare un texel e' una scrittura
+// a 16 bit in VRAM. Ogni frame si ridisegnano solo i texel in ov_queue e i
+// due del giocatore quando cambia chunk; tutto solo dopo overview_build().
+static int ov_player=-1;                // texel del giocatore
+
+static void ov_plot(int i){
+    int tx=i&(OV_N-1), ty=i/OV_N;
+    u8 c = i==ov_player ? BG_ART[BGT_PLAYER].ov
+         : (ov_seen[i>>3] & (1<<(i&7))) ? BG_ART[ov_get(i)].ov : BG_ART[TILE_EMPTY].ov;
+    vu16* p = (vu16*)CHAR_BASE_BLOCK(BGW_CHAR)
+            + (OV_TILE0 + (ty>>3)*(OV_N/8) + (tx>>3))*16 + (ty&7)*2 + ((tx&7)>>2);
+    int sh=(tx&3)*4;
+    *p = (u16)((*p & ~(15<<sh)) | (c<<sh));
+}
+
+static void draw_overview(){
+    int pi=(player.y>>CHUNK_SHIFT)*OV_N + (player.x>>CHUNK_SHIFT);
+    if (ov_full){
+        ov_player=pi;
+        for(int i=0;i<OV_N*OV_N;i++) ov_plot(i);
+        ov_full=0;
+    } else {
+        for(int q=0;q<ov_qn;q++) ov_plot(ov_queue[q]);
+        if (pi!=ov_player){ int old=ov_player; ov_player=pi; if (old>=0) ov_plot(old); ov_plot(pi); }
+    }
+    ov_qn=0;
+    REG_DISPCNT |= BG2_ON;
 }
 
 static void draw_minimap(){
-    int startx = player.x-6; if (startx<0) startx=0; if (startx>MAP_W-12) startx=MAP_W-12;
-    int starty = player.y-6; if (starty<0) starty=0; if (starty>MAP_H-12) starty=MAP_H-12;
-    for(int y=0;y<12;y++){
-        int sy = 1+y;
-        iprintf("\x1b[%d;%dH", sy, 19);
-        for(int x=0;x<12;x++){
+    if (render_mode==RENDER_BG){ draw_overview(); return; }
+    int startx = player.x-MM_N/2; if (startx<0) startx=0; if (startx>MAP_W-MM_N) startx=MAP_W-MM_N;
+    int starty = player.y-MM_N/2; if (starty<0) starty=0; if (starty>MAP_H-MM_N) starty=MAP_H-MM_N;
+    if (startx!=mm_sx || starty!=mm_sy) mm_full=1;
+    if (!mm_full) return;
+    for(int y=0;y<MM_N;y++){
+        for(int x=0;x<MM_N;x++){
             int mx=startx+x, my=starty+y;
-            char ch = map_data[my][mx];
-            char m = (mx==player.x && my==player.y) ? '@' :
-                      (ch==TILE_GRASS?'g':
-                       ch==TILE_TREE?'y':
-                       ch==TILE_WATER?'w':
-                       ch==TILE_SAND?'s':
-                       ch==TILE_WALL?'#':
-                       ch==TILE_BASE?'=':
-                       ch==TILE_TOWER?'t':
-                       ch==TILE_FARM?'f':
-                       ch==TILE_FIRE?'h':
-                       ch==TILE_POST?'p':'.');
-            putchar(m);
+            char m = (mx==player.x && my==player.y) ? '@' : TILE_PROPS[map_get(mx,my)].mini;
+            scr_put(MM_X+x, MM_Y+y, m);
         }
     }
+    mm_full=0; mm_sx=startx; mm_sy=starty;
+}
+
+// HUD a widget: ognuno ha una posizione fissa, un'etichetta (scritta solo
+// dopo cls()) e un valore legato a una variabile del gioco. draw_hud()
+// confronta il valore con l'ultimo disegnato e riscrive solo i widget
+// cambiati: nel frame tipico nessuna cella e nessun printf.
+typedef struct {
+    u8 x, y, w;                 // cella e larghezza del valore
+    u16 label;                  // ID del testo fisso che finisce in (x,y)
+    const int* src;             // NULL: solo etichetta
+    const u16* names;           // se c'e', il valore sceglie un testo invece di un numero
+} HudWidget;
+
+static const u16 DAY_NAMES[2] = { S_DAY, S_NIGHT };
+static const int mission_total = MISSION_DEF_COUNT;
+static int hud_night;           // is_night() dell'ultimo frame
+
+static const HudWidget HUD_WIDGETS[] = {
+    { 6, ROW_STATUS, 3, S_HUD_WOOD,     &player.wood,     0 },
+    {17, ROW_STATUS, 3, S_HUD_STONE,    &player.stone,    0 },
+    {27, ROW_STATUS, 3, S_HUD_ORBS,     &player.orbs,     0 },
+    { 9, ROW_COMP,   1, S_HUD_COMP,     &companion_count, 0 },
+    {12, ROW_COMP,   6, S_HUD_SEP,      &hud_night,       DAY_NAMES },
+    { 9, ROW_HUD,    1, S_HUD_MISSIONS, &missions_done,   0 },
+    {11, ROW_HUD,    1, S_HUD_OF,       &mission_total,   0 },
+    {24, ROW_HUD,    0, S_HUD_MENU,     0,                0 },
+};
+#define HUD_WIDGET_COUNT (int)(sizeof(HUD_WIDGETS)/sizeof(HUD_WIDGETS[0]))
+static int hud_val[HUD_WIDGET_COUNT];
+
+static void hud_widget(const HudWidget* w, int v){
+    if (w->names){ scr_text(w->x, w->y, w->w, str(w->names[v])); return; }
+    static const u16 LIMIT[5] = { 0, 9, 99, 999, 9999 };   // satura a w cifre
+    char b[6], *p;
+    if (v<0) v=0;
+    if (v>LIMIT[w->w]) v=LIMIT[w->w];
+    p=fmt_u(b+5, (u32)v); b[5]='\0';
+    scr_text(w->x, w->y, w->w, p);
 }
 
 static void draw_hud(){
-    int done=0; for(int i=0;i<MAX_MISSIONS;i++) if (MISSIONS[i].completed) done++;
-    iprintf("\x1b[%d;1H", VIEW_H+1);
-    iprintf("Missioni: %d/%d   START: Menu (Save/Load/Missioni/Aiuto)              \n", done, MAX_MISSIONS);
+    hud_night=is_night();
+    for(int i=0;i<HUD_WIDGET_COUNT;i++){
+        const HudWidget* w=&HUD_WIDGETS[i];
+        if (hud_full){ const char* l=str(w->label); int n=(int)strlen(l); scr_text(w->x-n, w->y, n, l); }
+        if (!w->src || (!hud_full && *w->src==hud_val[i])) continue;
+        hud_val[i]=*w->src;
+        hud_widget(w, hud_val[i]);
+    }
+    hud_full=0;
+    if (msg_dirty){ scr_text(0, ROW_MSG, 2*SCR_W, msg_text); msg_dirty=0; }
+}
+
+#ifdef FF_PROFILE
+// Overlay del profiler sulle righe alte della vista: le righe si ricalcolano
+// dal ring ogni PROF_OVERLAY_FRAMES frame e si riscrivono ogni frame (scr_text
+// tocca solo le celle ripassate nel frame da vista e minimappa).
+#define PROF_OVERLAY_FRAMES 30
+#define PROF_ROWS (PROF_COUNT+2)
+static char prof_lines[PROF_ROWS][48] EWRAM_BSS;   // piu' largo di SCR_W: i numeri grandi si troncano a video
+
+static void prof_overlay(){
+    if (prof_age==0){
+        u32 mn[PROF_COUNT], mx[PROF_COUNT], sum[PROF_COUNT]; u16 n[PROF_COUNT];
+        for(int i=0;i<PROF_COUNT;i++){ mn[i]=0xFFFFFFFFu; mx[i]=0; sum[i]=0; n[i]=0; }
+        for(int i=0;i<prof_filled;i++){
+            int sc=prof_ring_scope[i]; u32 t=prof_ring_ticks[i];
+            if (t<mn[sc]) mn[sc]=t;
+            if (t>mx[sc]) mx[sc]=t;
+            sum[sc]+=t; n[sc]++;
+        }
+        sniprintf(prof_lines[0], sizeof(prof_lines[0]), "%-8s%7s%7s%7s", PROF_UNIT, "min", "avg", "max");
+        for(int i=0;i<PROF_COUNT;i++){
+            if (n[i]) sniprintf(prof_lines[1+i], sizeof(prof_lines[0]), "%-8s%7lu%7lu%7lu", PROF_NAMES[i],
+                                (unsigned long)mn[i], (unsigned long)(sum[i]/n[i]), (unsigned long)mx[i]);
+            else sniprintf(prof_lines[1+i], sizeof(prof_lines[0]), "%-8s%7s", PROF_NAMES[i], "-");
+        }
+        sniprintf(prof_lines[PROF_ROWS-1], sizeof(prof_lines[0]), "VBlank perse: %lu", (unsigned long)prof_missed);
+    }
+    if (++prof_age>=PROF_OVERLAY_FRAMES) prof_age=0;
+    for(int r=0;r<PROF_ROWS;r++) scr_text(0, r, SCR_W, prof_lines[r]);
+}
+#endif
+
+// Nemici notturni --------------------------------------------------------------
+// Di notte emergono nemici che inseguono il giocatore. Tutti seguono lo stesso
+// campo di distanze: una BFS dal giocatore su una finestra FLOW_N x FLOW_N
+// centrata su di lui, che aggira muri, acqua e torrette (TF_AI_BLOCK). Ogni
+// nemico scende verso la cella vicina con distanza minore. Il campo si
+// ricostruisce a fette di FLOW_BUDGET celle per frame in un secondo buffer e
+// prende il posto di quello in uso solo a BFS finita; i nemici si muovono a
+// turno, ENEMY_MOVES per frame. Il costo per frame e' quindi fisso, qualunque
+// sia il numero di inseguitori.
+#define FLOW_SHIFT   5
+#define FLOW_N       (1<<FLOW_SHIFT)    // finestra 32x32
+#define FLOW_BUDGET  256                // celle espanse per frame: BFS completa in 4 frame
+#define FLOW_WALL    0xFE               // cella bloccata
+#define FLOW_FAR     0xFF               // non raggiunta o fuori finestra
+#define MAX_ENEMY    32
+#define ENEMY_MOVES  8                  // nemici mossi per frame: ognuno fa un passo ogni 4 frame
+#define ENEMY_SPAWN_FRAMES 40           // di notte, un tentativo di comparsa ogni tanti frame
+#define ENEMY_SPAWN_MIN    10           // distanza minima (Chebyshev) dal giocatore
+#define ENEMY_GRACE_FRAMES 90           // dopo battaglie e menu, nessun assalto per un po'
+
+typedef struct { s16 x, y; u8 alive; } Enemy;
+
+static Enemy enemies[MAX_ENEMY];
+static int enemy_count, enemy_turn, enemy_spawn_timer, enemy_grace;
+
+static u8  flow_dist[2][FLOW_N*FLOW_N] EWRAM_BSS;
+static s16 flow_ox[2], flow_oy[2];      // angolo della finestra per buffer
+static u8  flow_cur;                    // buffer pronto; l'altro e' in costruzione
+static u16 flow_q[FLOW_N*FLOW_N] EWRAM_BSS;
+static u16 flow_qh, flow_qt;
+static u8  flow_busy, flow_stale=1;
+static s16 flow_sx=-1, flow_sy=-1;      // sorgente dell'ultima BFS avviata
+
+// Chiamata quando cambia una tile (costruzioni): la prossima BFS riparte.
+static void flow_invalidate(){ flow_stale=1; }
+
+static int ai_passable(int x,int y){
+    u8 f=TILE_PROPS[map_get(x,y)].flags;
+    return (f & TF_PASS) && !(f & TF_AI_BLOCK);
+}
+
+static u8 flow_at(int x,int y){
+    int lx=x-flow_ox[flow_cur], ly=y-flow_oy[flow_cur];
+    if ((unsigned)lx>=FLOW_N || (unsigned)ly>=FLOW_N) return FLOW_FAR;
+    return flow_dist[flow_cur][ly<<FLOW_SHIFT | lx];
+}
+
+static void flow_begin(){
+    int w=flow_cur^1;
+    int ox=player.x-FLOW_N/2; if (ox<0) ox=0; if (ox>MAP_W-FLOW_N) ox=MAP_W-FLOW_N;
+    int oy=player.y-FLOW_N/2; if (oy<0) oy=0; if (oy>MAP_H-FLOW_N) oy=MAP_H-FLOW_N;
+    flow_ox[w]=(s16)ox; flow_oy[w]=(s16)oy;
+    memset(flow_dist[w], FLOW_FAR, sizeof(flow_dist[w]));
+    u16 i=(u16)((player.y-oy)<<FLOW_SHIFT | (player.x-ox));
+    flow_dist[w][i]=0; flow_q[0]=i; flow_qh=0; flow_qt=1;
+    flow_sx=(s16)player.x; flow_sy=(s16)player.y;
+    flow_busy=1; flow_stale=0;
+}
+
+// Una fetta di BFS; una nuova parte solo quando il giocatore si e' spostato.
+static void flow_step(){
+    static const s8 DX[4]={1,-1,0,0}, DY[4]={0,0,1,-1};
+    if (!flow_busy){
+        if (!flow_stale && player.x==flow_sx && player.y==flow_sy) return;
+        flow_begin();
+    }
+    int w=flow_cur^1;
+    u8* d=flow_dist[w];
+    for(int n=0; n<FLOW_BUDGET && flow_qh<flow_qt; n++){
+        int i=flow_q[flow_qh++];
+        int x=i&(FLOW_N-1), y=i>>FLOW_SHIFT;
+        u8 nd=d[i]+1;
+        if (nd>=FLOW_WALL) continue;
+        for(int k=0;k<4;k++){
+            int nx=x+DX[k], ny=y+DY[k];
+            if ((unsigned)nx>=FLOW_N || (unsigned)ny>=FLOW_N) continue;
+            int j=ny<<FLOW_SHIFT | nx;
+            if (d[j]!=FLOW_FAR) continue;
+            if (!ai_passable(flow_ox[w]+nx, flow_oy[w]+ny)){ d[j]=FLOW_WALL; continue; }
+            d[j]=nd; flow_q[flow_qt++]=(u16)j;
+        }
+    }
+    if (flow_qh>=flow_qt){ flow_cur=(u8)w; flow_busy=0; }
+}
+
+static void enemy_kill(int i){
+    Enemy* e=&enemies[i];
+    occ_remove(e->x, e->y); view_mark_cell(e->x, e->y);
+    e->alive=0; enemy_count--;
+}
+
+static void enemies_clear(){
+    for(int i=0;i<MAX_ENEMY;i++) if (enemies[i].alive) enemy_kill(i);
+}
+
+// Compare in una cella libera raggiungibile dal giocatore, lontana almeno
+// ENEMY_SPAWN_MIN; pochi tentativi, poi si riprova al prossimo giro.
+static void enemy_spawn(){
+    int i=0;
+    while (i<MAX_ENEMY && enemies[i].alive) i++;
+    if (i==MAX_ENEMY) return;
+    int c=flow_cur;
+    for(int t=0;t<4;t++){
+        int x=flow_ox[c]+rng_range(RNG_AI,0,FLOW_N-1), y=flow_oy[c]+rng_range(RNG_AI,0,FLOW_N-1);
+        int adx=x-player.x, ady=y-player.y; if (adx<0) adx=-adx; if (ady<0) ady=-ady;
+        if (adx<ENEMY_SPAWN_MIN && ady<ENEMY_SPAWN_MIN) continue;
+        if (flow_at(x,y)>=FLOW_WALL || occ_find(x,y)!=OCC_NONE) continue;
+        enemies[i]=(Enemy){ (s16)x, (s16)y, 1 };
+        occ_add(x, y, ENT_ENEMY|i); view_mark_cell(x, y);
+        enemy_count++;
+        return;
+    }
+}
+
+static void enemy_move(int i){
+    static const s8 DX[4]={1,-1,0,0}, DY[4]={0,0,1,-1};
+    Enemy* e=&enemies[i];
+    int adx=e->x-player.x, ady=e->y-player.y;
+    if ((adx==0 && (ady==1 || ady==-1)) || (ady==0 && (adx==1 || adx==-1))){
+        // Contatto: il nemico diventa una battaglia, ma solo se si e' nel mondo
+        // e la tregua dopo l'ultima schermata e' finita.
+        if (gstate!=GS_WORLD || gstate_next!=GS_WORLD || enemy_grace>0) return;
+        enemy_kill(i);
+        wild=random_wild((Biome)TILE_PROPS[map_get(player.x,player.y)].biome);
+        set_state(GS_BATTLE);
+        return;
+    }
+    u8 here=flow_at(e->x,e->y);
+    if (here==FLOW_FAR){ enemy_kill(i); return; }      // rimasto fuori dalla finestra
+    int bx=e->x, by=e->y; u8 best=here;
+    for(int k=0;k<4;k++){
+        int nx=e->x+DX[k], ny=e->y+DY[k];
+        u8 d=flow_at(nx,ny);
+        if (d<best && occ_find(nx,ny)==OCC_NONE){ best=d; bx=nx; by=ny; }
+    }
+    if (bx==e->x && by==e->y) return;
+    occ_move(e->x, e->y, bx, by);
+    view_mark_cell(e->x, e->y); view_mark_cell(bx, by);
+    e->x=(s16)bx; e->y=(s16)by;
+}
+
+// Un frame di IA: fetta di BFS, comparse/ritirate e ENEMY_MOVES nemici a turno.
+static void enemies_step(){
+    if (is_night() || enemy_count>0) flow_step();       // di giorno il campo non serve
+    // La notte dura a passi: fermi in battaglia o nel menu non deve arrivare
+    // un'ondata dopo l'altra.
+    if (gstate!=GS_WORLD){ enemy_grace=ENEMY_GRACE_FRAMES; }
+    else if (enemy_grace>0) enemy_grace--;
+    if (is_night()){
+        if (gstate==GS_WORLD && ++enemy_spawn_timer>=ENEMY_SPAWN_FRAMES){ enemy_spawn_timer=0; if (enemy_count<MAX_ENEMY) enemy_spawn(); }
+    } else if (enemy_count>0){
+        // All'alba spariscono, uno per frame.
+        for(int i=0;i<MAX_ENEMY;i++) if (enemies[i].alive){ enemy_kill(i); break; }
+        return;
+    }
+    for(int n=0;n<ENEMY_MOVES;n++){
+        if (enemies[enemy_turn].alive) enemy_move(enemy_turn);
+        if (++enemy_turn>=MAX_ENEMY) enemy_turn=0;
+    }
+}
+
+// Economia e difesa: un tick ogni BLD_TICK_FRAMES frame aggiorna tutti gli
+// edifici in O(edifici): i produttori accumulano scorte fino al tetto (si
+// raccolgono con A), le torrette ricaricano. Poi ogni nemico chiede ai
+// secchi vicini una torretta carica entro la gittata: costa O(nemici), non
+// O(torrette x celle).
+#define BLD_TICK_FRAMES 15
+#define TOWER_RANGE     4               // < 1<<BKT_SHIFT: la query resta su 2x2 secchi
+
+typedef struct { u8 period; u8 cap; } BldProps;    // tick tra due produzioni o ricarica; tetto scorte
+static const BldProps BLD_PROPS[TILE_COUNT] = {
+    [TILE_POST]  = { 20, 5 },           // legno o pietra
+    [TILE_FARM]  = { 12, 5 },           // legno
+    [TILE_TOWER] = {  8, 0 },           // ricarica dopo un colpo
+};
+static int bld_timer;
+
+static void buildings_tick(){
+    for(int i=0;i<bld_count;i++){
+        Building* b=&blds[i];
+        const BldProps* p=&BLD_PROPS[b->tile];
+        if (b->timer && --b->timer) continue;
+        if (b->stock<p->cap){ b->stock++; b->timer=p->period; }
+    }
+    for(int i=0;i<MAX_ENEMY;i++){
+        if (!enemies[i].alive) continue;
+        Building* t=bld_near(enemies[i].x, enemies[i].y, TOWER_RANGE, TILE_TOWER, 1);
+        if (!t) continue;
+        enemy_kill(i);
+        t->timer=BLD_PROPS[TILE_TOWER].period;
+        if (gstate==GS_WORLD) show_msg(20, str(S_TOWER_HIT));
+    }
+}
+
+// Sprite ---------------------------------------------------------------------
+// Con il renderer BG giocatore, NPC e nemici sono sprite 8x8 sopra BG1:
+// muoversi non riscrive lo sfondo. obj_build() riempie ogni frame una copia
+// ombra dell'OAM in RAM con le sole entita' nell'area mostrata da BG1
+// (bg_visible), il giocatore per primo (a parita' di priorita' la voce piu'
+// bassa sta sopra), e nasconde le voci avanzate dal frame prima. Il gestore della VBlank copia in OAM con un
+// solo DMA le voci toccate dall'ultima copia, mai tutte le 128: il costo
+// segue le entita' visibili. Le posizioni sono in pixel, quindi i nemici
+// scivolano verso la cella nuova a OBJ_SLIDE pixel per frame invece di
+// saltare; il giocatore no, perche' la camera lo segue a scatti di una cella.
+#define OBJ_MAX    128          // voci OAM dell'hardware
+#define OBJ_BLOCK  4            // charblock degli sprite (0x06010000)
+#define OBJ_PAL    0            // banco della palette sprite
+#define OBJ_SLIDE  2            // pixel per frame; 8 deve esserne multiplo
+#define OBJ_SLOT_NPC   1
+#define OBJ_SLOT_ENEMY (OBJ_SLOT_NPC+MAX_NPC)
+#define OBJ_SLOTS      (OBJ_SLOT_ENEMY+MAX_ENEMY)
+
+static OBJATTR obj_shadow[OBJ_MAX];
+static s16 obj_px[OBJ_SLOTS], obj_py[OBJ_SLOTS];   // posizione disegnata, pixel di mondo
+static u8  obj_live[OBJ_SLOTS];                     // entita' disegnata nel frame prima
+static int obj_used;                                // voci scritte in questo frame
+static volatile int obj_flush;                      // voci da copiare alla prossima VBlank
+static volatile u8  obj_ready;                      // 0 mentre obj_build() scrive l'ombra
+
+// Le tile degli sprite sono quelle delle entita' di BG_ART, con la base trasparente.
+static void obj_init(){
+    u32* dst = (u32*)CHAR_BASE_BLOCK(OBJ_BLOCK);
+    for(int t=BGT_NPC;t<BGT_COUNT;t++){
+        const BgTileArt* a = &BG_ART[t];
+        for(int r=0;r<8;r++){
+            u32 row=0;
+            for(int c=0;c<8;c++) if (a->art[r*8+c]=='x') row |= (u32)a->detail << (c*4);
+            *dst++ = row;
+        }
+    }
+    for(int i=0;i<16;i++) OBJ_COLORS[OBJ_PAL*16+i] = BG_PAL_COLORS[i];
+    for(int i=0;i<OBJ_MAX;i++) obj_shadow[i].attr0 = ATTR0_DISABLED;
+    obj_flush=OBJ_MAX; obj_ready=1;
+    REG_DISPCNT |= OBJ_1D_MAP;
+}
+
+static void vblank_isr(){
+    if (!obj_ready || !obj_flush) return;
+    DMA3COPY(obj_shadow, OAM, COPY32 | (u32)(obj_flush*sizeof(OBJATTR)/4));
+    obj_flush=0;
+}
+
+static void obj_put(int slot,int mx,int my,int tile,int slide,int vx,int vy){
+    if (!bg_visible(mx,my,vx,vy) || obj_used>=OBJ_MAX){ obj_live[slot]=0; return; }
+    int tx=mx*8, ty=my*8, dx=tx-obj_px[slot], dy=ty-obj_py[slot];
+    if (!slide || !obj_live[slot] || dx>8 || -dx>8 || dy>8 || -dy>8){ obj_px[slot]=(s16)tx; obj_py[slot]=(s16)ty; }
+    else {
+        obj_px[slot] += dx>0 ? OBJ_SLIDE : dx<0 ? -OBJ_SLIDE : 0;
+        obj_py[slot] += dy>0 ? OBJ_SLIDE : dy<0 ? -OBJ_SLIDE : 0;
+    }
+    obj_live[slot]=1;
+    OBJATTR* o = &obj_shadow[obj_used++];
+    o->attr0 = OBJ_Y(obj_py[slot]-vy*8) | ATTR0_COLOR_16 | ATTR0_SQUARE;
+    o->attr1 = OBJ_X(obj_px[slot]-vx*8) | ATTR1_SIZE_8;
+    o->attr2 = OBJ_CHAR(tile-BGT_NPC) | ATTR2_PRIORITY(1) | ATTR2_PALETTE(OBJ_PAL);
+}
+
+static void obj_build(){
+    if (render_mode!=RENDER_BG) return;
+    int vx, vy; view_camera(&vx, &vy);
+    int prev=obj_used;
+    obj_ready=0;
+    __asm__ volatile("" ::: "memory");  // nessuna scrittura dell'ombra prima di obj_ready=0
+    obj_used=0;
+    obj_put(0, player.x, player.y, BGT_PLAYER, 0, vx, vy);
+    for(int i=0;i<npc_count;i++) obj_put(OBJ_SLOT_NPC+i, npcs[i].x, npcs[i].y, BGT_NPC, 0, vx, vy);
+    for(int i=0;i<MAX_ENEMY;i++){
+        if (enemies[i].alive) obj_put(OBJ_SLOT_ENEMY+i, enemies[i].x, enemies[i].y, BGT_ENEMY, 1, vx, vy);
+        else obj_live[OBJ_SLOT_ENEMY+i]=0;
+    }
+    for(int i=obj_used;i<prev;i++) obj_shadow[i].attr0 = ATTR0_DISABLED;
+    int n = obj_used>prev ? obj_used : prev;
+    if (n>obj_flush) obj_flush=n;       // una VBlank saltata somma le voci da copiare
+    __asm__ volatile("" ::: "memory");  // l'ombra e' completa prima di obj_ready
+    obj_ready=1;
+    REG_DISPCNT |= OBJ_ON;
 }
 
 // Interazioni & logica -------------------------------------------------------
-typedef struct { const char* name; int required_wood; int required_stone; char tile_char; } BuildDefLocal;
+typedef struct { const char* name; int required_wood; int required_stone; u8 tile; } BuildDefLocal;
 static BuildDefLocal BUILDINGS_LOCAL[] = {
     {"PostoLavoro", 10, 6, TILE_POST},
     {"Torretta",    14, 10, TILE_TOWER},
@@ -320,218 +1677,491 @@ static BuildDefLocal BUILDINGS_LOCAL[] = {
 };
 static int sel_build_idx=0;
 static const char* current_build_name(){ return BUILDINGS_LOCAL[sel_build_idx].name; }
-static char current_build_tile(){ return BUILDINGS_LOCAL[sel_build_idx].tile_char; }
+static u8 current_build_tile(){ return BUILDINGS_LOCAL[sel_build_idx].tile; }
 static int current_build_w(){ return BUILDINGS_LOCAL[sel_build_idx].required_wood; }
 static int current_build_s(){ return BUILDINGS_LOCAL[sel_build_idx].required_stone; }
 
-static int can_build_here(char tile){
-    if (tile==TILE_EMPTY || tile==TILE_BASE) return 1;
-    if (tile==TILE_GRASS || tile==TILE_SAND) return 1;
-    return 0;
+static int can_build_here(u8 tile){ return TILE_PROPS[tile].flags & TF_BUILD; }
+// Tile nel mondo + voce nel registro degli edifici. 0 se mods[] e' pieno.
+static int place_building(int x,int y,u8 t){
+    if (!map_set(x, y, t)) return 0;
+    bld_add(x, y, t);
+    view_mark(x, y);
+    flow_invalidate();
+    return 1;
 }
 static void try_build(){
-    char* cell = &map_data[player.y][player.x];
-    if (!can_build_here(*cell)) { iprintf("Non puoi costruire qui.\n"); msg_timer=40; return; }
+    if (!can_build_here(map_get(player.x,player.y))) { show_msg(40, str(S_CANT_BUILD)); return; }
     if (player.wood < current_build_w() || player.stone < current_build_s()){
-        iprintf("Materiali insufficienti per %s.\n", current_build_name()); msg_timer=40; return;
+        show_msg(40, str(S_NO_MATERIALS), current_build_name()); return;
     }
-    player.wood -= current_build_w(); player.stone -= current_build_s(); *cell = current_build_tile();
-    iprintf("Costruito: %s!\n", current_build_name()); msg_timer=60;
+    if (!place_building(player.x, player.y, current_build_tile())){ show_msg(40, str(S_TOO_MANY_BUILDINGS)); return; }
+    player.wood -= current_build_w(); player.stone -= current_build_s();
+    show_msg(60, str(S_BUILT), current_build_name());
 }
 
-static int adjacent(int x1,int y1,int x2,int y2){ int dx=x1-x2; if(dx<0)dx=-dx; int dy=y1-y2; if(dy<0)dy=-dy; return (dx+dy)==1; }
+// NPC in una delle 4 celle vicine al giocatore, o NULL.
+static NPC* adjacent_npc(){
+    static const s8 dir[4][2] = {{0,-1},{1,0},{0,1},{-1,0}};
+    for(int d=0;d<4;d++){
+        NPC* n = npc_at(player.x+dir[d][0], player.y+dir[d][1]);
+        if (n) return n;
+    }
+    return NULL;
+}
 
 static void gift_from_npc(NPC* n){
+    const NpcDef* d=&NPC_DEFS[n-npcs];
     if (n->gave_gift) return;
     n->gave_gift=1;
-    player.wood += n->gift_wood;
-    player.stone += n->gift_stone;
-    player.orbs += n->gift_orb;
+    player.wood += d->gift_wood;
+    player.stone += d->gift_stone;
+    player.orbs += d->gift_orb;
 }
 
+// Dialogo NPC (GS_MSG): talk_to_nearby_npc() sceglie l'NPC, lo stato mostra
+// il testo e attende A.
+static NPC* talk_npc;
+
 static void talk_to_nearby_npc(){
-    for(int i=0;i<npc_count;i++){
-        if (adjacent(player.x,player.y, npcs[i].x,npcs[i].y)){
-            cls();
-            iprintf("%s:\n\n", npcs[i].name);
-            for(int l=0;l<npcs[i].line_count;l++) iprintf("  %s\n", npcs[i].lines[l]);
-            gift_from_npc(&npcs[i]);
-            iprintf("\nHai ricevuto: +%d Legno, +%d Pietra, +%d Sfera.\n", npcs[i].gift_wood, npcs[i].gift_stone, npcs[i].gift_orb);
-            iprintf("\nPremi A per continuare.");
-            while(1){ if (key_down() & KEY_A) break; wait_vblank(); }
-            return;
+    NPC* n = adjacent_npc();
+    if (!n){ show_msg(30, str(S_NOBODY)); return; }
+    talk_npc=n; set_state(GS_MSG);
+}
+
+// La conversazione si decodifica una pagina alla volta in talk_buf: la pagina
+// finisce a un "--" degli asset (\f) o dopo TALK_ROWS righe a schermo.
+// Il dono arriva con l'ultima pagina.
+#define TALK_ROWS 12
+static StrReader talk_rd;
+static int talk_next;                       // primo carattere della prossima pagina, 0 = finita
+static char talk_buf[TALK_ROWS*(SCR_W+1)+1];
+
+static void talk_page(){
+    const NpcDef* d=&NPC_DEFS[talk_npc-npcs];
+    int n=0, row=0, col=2, c=talk_next;
+    talk_buf[n++]=' '; talk_buf[n++]=' ';
+    while (c && c!='\f'){
+        if (c=='\n'){ col=SCR_W; }
+        else { talk_buf[n++]=(char)c; col++; }
+        if (col>=SCR_W){
+            if (c=='\n') talk_buf[n++]='\n';
+            if (++row==TALK_ROWS){ c=str_getc(&talk_rd); break; }
+            talk_buf[n++]=' '; talk_buf[n++]=' '; col=2;
         }
+        c=str_getc(&talk_rd);
     }
-    iprintf("Non c'e' nessuno con cui parlare qui.\n"); msg_timer=30;
+    if (c=='\f' || c=='\n') c=str_getc(&talk_rd);  // la pagina nuova non parte con una riga vuota
+    while (n>0 && talk_buf[n-1]==' ') n--;  // rientro di una riga mai iniziata
+    talk_buf[n]='\0';
+    talk_next=c;
+    cls();
+    iprintf(str(S_TALK_HEAD), str(d->name));
+    for(const char* t=talk_buf; *t; t++) putchar(*t);     // una pagina supera il buffer di iprintf
+    if (talk_next){ str_print(S_TALK_MORE); return; }
+    gift_from_npc(talk_npc);
+    iprintf(str(S_TALK_GIFT), d->gift_wood, d->gift_stone, d->gift_orb);
+    str_print(S_TALK_END);
+}
+static void talk_enter(){
+    str_open(&talk_rd, NPC_DEFS[talk_npc-npcs].talk);
+    talk_next=str_getc(&talk_rd);
+    talk_page();
+}
+static void talk_update(){
+    if (!(input.pressed & KEY_A)) return;
+    if (talk_next) talk_page();
+    else set_state(GS_WORLD);
 }
 
 static void try_gather_or_action(){
-    char* cell = &map_data[player.y][player.x];
-    if (*cell==TILE_WALL){ iprintf("Una parete blocca il passaggio.\n"); msg_timer=40; return; }
-    if (*cell==TILE_WATER){ iprintf("L'acqua ti ostruisce.\n"); msg_timer=40; return; }
-    if (*cell==TILE_TREE){
-        if (rand_range(0,99)<70){ player.wood++; iprintf("Tagli un ramo: +1 Legno.\n"); }
-        else iprintf("L'albero resiste.\n");
-        msg_timer=30; return;
-    }
-    if (*cell==TILE_GRASS || *cell==TILE_SAND){
-        if (rand_range(0,99)<18){ wild=random_wild(); gstate=GS_BATTLE; return; }
-        iprintf("Fruscio... nessun incontro.\n"); msg_timer=20; return;
-    }
-    if (*cell==TILE_POST){
-        int bonus = companion_count>0 ? 1 : 0;
-        int roll = rand_range(0,1);
-        if (roll==0){ player.wood += 1+bonus; iprintf("+%d Legno dal Posto di lavoro.\n", 1+bonus); }
-        else { player.stone += 1+bonus; iprintf("+%d Pietra dal Posto di lavoro.\n", 1+bonus); }
-        msg_timer=30; return;
-    }
-    if (*cell==TILE_FARM){ player.wood += 1; iprintf("+1 Legno dalla Farm.\n"); msg_timer=20; return; }
-    if (*cell==TILE_FIRE){
-        for(int i=0;i<companion_count;i++){ companions[i].hp += 4; if (companions[i].hp>companions[i].max_hp) companions[i].hp=companions[i].max_hp; }
-        iprintf("Falò caldo: i compagni si curano.\n"); msg_timer=30; return;
+    const TileProps* tp = &TILE_PROPS[map_get(player.x,player.y)];
+    switch(tp->action){
+        case ACT_WALL:  show_msg(40, str(S_WALL)); return;
+        case ACT_WATER: show_msg(40, str(S_WATER)); return;
+        case ACT_CHOP:
+            if (rng_range(RNG_LOOT,0,99)<70){ player.wood++; show_msg(30, str(S_CHOP_OK)); }
+            else show_msg(30, str(S_CHOP_FAIL));
+            return;
+        case ACT_FORAGE:
+            if (rng_range(RNG_ENCOUNTER,0,99)<tp->encounter){ wild=random_wild((Biome)tp->biome); set_state(GS_BATTLE); return; }
+            show_msg(20, str(S_FORAGE_NONE)); return;
+        case ACT_POST: {
+            // Raccoglie le scorte prodotte dal tick: ogni unita' e' legno o pietra.
+            Building* b=bld_near(player.x, player.y, 0, TILE_POST, 0);
+            if (!b || !b->stock){ show_msg(30, str(S_POST_EMPTY)); return; }
+            int bonus = companion_count>0 ? 1 : 0, w=0, st=0;
+            for(int i=0;i<b->stock+bonus;i++){ if (rng_range(RNG_LOOT,0,1)==0) w++; else st++; }
+            player.wood += w; player.stone += st; b->stock=0;
+            show_msg(30, str(S_POST_YIELD), w, st);
+            return;
+        }
+        case ACT_FARM: {
+            Building* b=bld_near(player.x, player.y, 0, TILE_FARM, 0);
+            if (!b || !b->stock){ show_msg(20, str(S_FARM_EMPTY)); return; }
+            player.wood += b->stock; show_msg(20, str(S_FARM_YIELD), b->stock); b->stock=0;
+            return;
+        }
+        case ACT_FIRE:
+            for(int i=0;i<companion_count;i++){ companions[i].hp += 4; if (companions[i].hp>companions[i].max_hp) companions[i].hp=companions[i].max_hp; }
+            show_msg(30, str(S_FIRE_HEAL)); return;
+        default: talk_to_nearby_npc(); return;
     }
-    talk_to_nearby_npc();
 }
 
 static void try_craft_quick(){
-    if (player.wood>=5 && player.stone>=3){ player.wood-=5; player.stone-=3; player.orbs++; iprintf("Craft: Sfera +1 (tot %d)\n", player.orbs); msg_timer=30; return; }
+    if (player.wood>=5 && player.stone>=3){ player.wood-=5; player.stone-=3; player.orbs++; show_msg(30, str(S_CRAFT_ORB), player.orbs); return; }
     if (player.wood>=10 && player.stone>=6){
-        char* cell = &map_data[player.y][player.x];
-        if (can_build_here(*cell)){ player.wood-=10; player.stone-=6; *cell=TILE_POST; iprintf("Posto di lavoro posizionato.\n"); msg_timer=30; return; }
+        if (can_build_here(map_get(player.x,player.y)) && place_building(player.x, player.y, TILE_POST)){ player.wood-=10; player.stone-=6; show_msg(30, str(S_CRAFT_POST)); return; }
     }
-    iprintf("Materiali insufficienti per craft rapido.\n"); msg_timer=30;
+    show_msg(30, str(S_CRAFT_NONE));
 }
 
 static void try_throw_orb(){
-    if (player.orbs<=0){ iprintf("Non hai Sfere. Craft con SELECT.\n"); msg_timer=40; return; }
-    if (rand_range(0,99)<12){ wild=random_wild(); gstate=GS_BATTLE; iprintf("Una creatura appare!"); }
-    else { iprintf("Lanci una Sfera a vuoto."); player.orbs--; }
-    msg_timer=30;
+    if (player.orbs<=0){ show_msg(40, str(S_NO_ORBS)); return; }
+    if (rng_range(RNG_ENCOUNTER,0,99)<12){ wild=random_wild((Biome)TILE_PROPS[map_get(player.x,player.y)].biome); set_state(GS_BATTLE); show_msg(30, str(S_CREATURE_APPEARS)); }
+    else { show_msg(30, str(S_ORB_MISS)); player.orbs--; }
 }
 
 // Battaglie ------------------------------------------------------------------
-static int type_mul(ElemType a, ElemType b){ return type_multiplier(a,b); }
+// Le regole stanno in battle_step(): funzione pura di stato, azione e stato
+// RNG, senza input ne' console. battle_frame() ci mette sopra tastiera e testo;
+// host/battlesim.c la usa per simulare milioni di battaglie.
+typedef enum { BA_ATTACK=0, BA_SPECIAL, BA_CATCH, BA_FLEE } BattleAction;   // = voci del menu
+typedef enum { BR_ONGOING=-1, BR_FLED=0, BR_WON=2, BR_CAUGHT=3 } BattleResult;
+typedef enum { BE_NONE=0, BE_HIT, BE_NO_ORBS, BE_THROW } BattleEvent;
+
+typedef struct {
+    Creature wild;
+    u8 ally_type;           // ElemType della mossa speciale
+    u8 night;
+    s16 orbs;
+    u16 turns;              // azioni che hanno avuto effetto
+    u8 event;               // BattleEvent dell'ultimo passo, per il testo
+    s16 dmg;                // BE_HIT
+    s16 roll, chance;       // BE_THROW
+} Battle;
+
+static void battle_init(Battle* b, const Creature* w, ElemType ally, int night, int orbs){
+    memset(b, 0, sizeof(*b));
+    b->wild=*w; b->ally_type=ally; b->night=(u8)night; b->orbs=(s16)orbs;
+}
+
+static BattleResult battle_step(Battle* b, BattleAction a, u32* rng){
+    b->event=BE_NONE;
+    switch(a){
+        case BA_ATTACK:
+        case BA_SPECIAL: {
+            ElemType wt=creature_type(&b->wild);
+            int dmg = (a==BA_ATTACK) ? 4*type_mul(TYPE_NEUTRAL,wt) + (b->night?1:0)
+                                     : 6*type_mul((ElemType)b->ally_type,wt);
+            b->wild.hp-=dmg; if (b->wild.hp<0) b->wild.hp=0;
+            b->event=BE_HIT; b->dmg=(s16)dmg; b->turns++;
+            if (b->wild.hp==0) return BR_WON;
+            ability_tick(&b->wild, rng);
+            return BR_ONGOING;
+        }
+        case BA_CATCH:
+            if (b->orbs<=0){ b->event=BE_NO_ORBS; return BR_ONGOING; }
+            b->orbs--; b->turns++;
+            b->chance=(s16)((b->wild.max_hp-b->wild.hp)*100/(b->wild.max_hp+1)+10);
+            b->roll=(s16)xs_range(rng,0,99);
+            b->event=BE_THROW;
+            return b->roll<=b->chance ? BR_CAUGHT : BR_ONGOING;
+        default:
+            return BR_FLED;
+    }
+}
+
 
 static void battle_intro(){
     cls();
-    iprintf("Un %s (%s) selvatico appare!\n\n", wild.name, elem_name(wild.type));
-    iprintf("HP: %d/%d  Abilita: %s\n\n", wild.hp, wild.max_hp, wild.ability);
-    iprintf("  > Attacco rapido\n");
-    iprintf("    Mossa speciale\n");
-    iprintf("    Cattura\n");
-    iprintf("    Fuggi\n");
+    iprintf(str(S_BATTLE_INTRO), creature_name(&wild), ELEM_NAME[creature_type(&wild)]);
+    iprintf(str(S_BATTLE_STATS), wild.hp, wild.max_hp, ABILITIES[wild.ability].name);
 }
 static int battle_menu(int sel){
     int base=5;
-    const char* labels[4] = {"Attacco rapido","Mossa speciale","Cattura","Fuggi"};
-    for(int i=0;i<4;i++){ iprintf("\x1b[%d;1H", base+i); iprintf("%c %s  ", (i==sel?'>':' '), labels[i]); }
+    static const u16 labels[4] = { S_ACT_ATTACK, S_ACT_SPECIAL, S_ACT_CATCH, S_ACT_FLEE };
+    for(int i=0;i<4;i++){ iprintf("\x1b[%d;1H", base+i); iprintf("%c %s  ", (i==sel?'>':' '), str(labels[i])); }
     return sel;
 }
-static int do_battle(){
-    int sel=0; battle_intro(); battle_menu(sel);
-    while(1){
-        u16 kd = key_down();
-        if (kd & KEY_UP)   { if(--sel<0) sel=3; battle_menu(sel); }
-        if (kd & KEY_DOWN) { if(++sel>3) sel=0; battle_menu(sel); }
-        if (kd & KEY_A){
-            if (sel==0){ int mult=type_mul(TYPE_NEUTRAL,wild.type); int dmg=4*mult + (is_night()?1:0); wild.hp-=dmg; if (wild.hp<0) wild.hp=0; iprintf("\x1b[10;1HColpisci per %d.       ", dmg); }
-            if (sel==1){ ElemType et=(companion_count>0?companions[0].type:TYPE_GRASS); int mult=type_mul(et,wild.type); int dmg=6*mult; wild.hp-=dmg; if (wild.hp<0) wild.hp=0; iprintf("\x1b[11;1HMossa %s: %d.      ", elem_name(et), dmg); }
-            if (sel==2){
-                if (player.orbs<=0){ iprintf("\x1b[12;1HNiente Sfere! "); }
-                else { int chance=(wild.max_hp-wild.hp)*100/(wild.max_hp+1)+10; int roll=rand_range(0,99); player.orbs--; iprintf("\x1b[12;1HLancio... (%d vs %d) ", roll, chance); if (roll<=chance){ iprintf("\nCatturato %s! Premi A...", wild.name); while(1){ if (key_down() & KEY_A) break; wait_vblank(); } if (companion_count<MAX_COMPANIONS){ companions[companion_count++]=wild; companions[companion_count-1].caught=1; } return 3; } else { iprintf("\nSi libera! "); } }
-            }
-            if (sel==3) return 0;
-            if (wild.hp==0){ iprintf("\nSconfitto! Premi A..."); while(1){ if (key_down() & KEY_A) break; wait_vblank(); } return 2; }
+// Battaglia (GS_BATTLE): un frame per update, con conferma a fine battaglia.
+typedef enum { BP_CHOOSE=0, BP_CAUGHT, BP_WON } BattlePhase;
+static Battle battle;
+static int battle_sel;
+static u8 battle_phase;
+
+static void battle_enter(){
+    battle_sel=0; battle_phase=BP_CHOOSE;
+    battle_intro(); battle_menu(battle_sel);
+    battle_init(&battle, &wild, companion_count>0 ? creature_type(&companions[0]) : TYPE_GRASS, is_night(), player.orbs);
+}
+
+static void battle_frame(){
+    u16 kd = input.pressed;
+    if (battle_phase!=BP_CHOOSE){
+        if (!(kd & KEY_A)) return;
+        if (battle_phase==BP_CAUGHT){
+            wild.caught=1;
+            if (companion_count<MAX_COMPANIONS) companions[companion_count++]=wild;
+            else { u16 m=(u16)box_deposit(&wild); show_msg(40, str(m), creature_name(&wild), box_count, BOX_CAP); }   // prima il deposito: box_count e' gia' aggiornato
         }
-        if (kd & KEY_B) return 0;
-        wait_vblank();
+        set_state(GS_WORLD);
+        return;
+    }
+    if (kd & KEY_UP)   { if(--battle_sel<0) battle_sel=3; battle_menu(battle_sel); }
+    if (kd & KEY_DOWN) { if(++battle_sel>3) battle_sel=0; battle_menu(battle_sel); }
+    if (kd & KEY_A){
+        int sel=battle_sel;
+        BattleResult r = battle_step(&battle, (BattleAction)sel, &rng_state[RNG_BATTLE]);
+        wild=battle.wild; player.orbs=battle.orbs;
+        if (battle.event==BE_HIT && sel==BA_ATTACK) { iprintf("\x1b[10;1H"); iprintf(str(S_HIT), battle.dmg); }
+        if (battle.event==BE_HIT && sel==BA_SPECIAL) { iprintf("\x1b[11;1H"); iprintf(str(S_SPECIAL_HIT), ELEM_NAME[battle.ally_type], battle.dmg); }
+        if (battle.event==BE_NO_ORBS) { iprintf("\x1b[12;1H"); str_print(S_BATTLE_NO_ORBS); }
+        if (battle.event==BE_THROW) { iprintf("\x1b[12;1H"); iprintf(str(S_THROW), battle.roll, battle.chance); }
+        if (r==BR_CAUGHT){ iprintf(str(S_CAUGHT), creature_name(&wild)); battle_phase=BP_CAUGHT; return; }
+        if (battle.event==BE_THROW) str_print(S_BROKE_FREE);
+        if (r==BR_FLED){ set_state(GS_WORLD); return; }
+        if (r==BR_WON){ str_print(S_WON); battle_phase=BP_WON; return; }
     }
+    if (kd & KEY_B) set_state(GS_WORLD);
 }
+static void battle_update(){ PROF(PROF_BATTLE, battle_frame()); }
 
 // BOSS (semplice trigger)
 static int near_boss_area(){ return (player.x>55 && player.x<75 && player.y>6 && player.y<20); }
 
-// Menu START -----------------------------------------------------------------
-static void show_menu(){
-    while(1){
-        cls();
-        iprintf("FaunaFrontierGBA — Menu\n");
-        iprintf("------------------------\n\n");
-        iprintf("A) Missioni & Aiuto\n");
-        iprintf("SELECT) SAVE   R) LOAD\n");
-        iprintf("B/START) Indietro\n");
-        while(1){
-            u16 kd = key_down();
-            if (kd & (KEY_B|KEY_START)) return;
-            if (kd & KEY_A){
-                cls();
-                iprintf("Missioni:\n\n");
-                for(int i=0;i<MAX_MISSIONS;i++){ iprintf("[%c] %s - %s\n", 0?'X':' ', MISSIONS[i].title, MISSIONS[i].desc); }
-                iprintf("\n- Muoviti, raccogli Legno/Pietra.\n- SELECT: craft rapido (Sfere, Posto).\n- L/R: edificio selezionato; L+A costruisci.\n- R+A lancia Sfera.\n- NPC danno indizi e doni.\n\nB/START per uscire.");
-                while(1){ u16 k2=key_down(); if (k2 & (KEY_B|KEY_START)) break; wait_vblank(); }
-                break;
+// Menu START (GS_MENU) ------------------------------------------------------
+typedef enum { MENU_MAIN=0, MENU_HELP, MENU_BOX } MenuPage;
+static u8 menu_page;
+
+static void menu_draw_main(){
+    menu_page=MENU_MAIN;
+    cls();
+    str_print(S_MENU);
+    iprintf(str(S_MENU_RENDER), str(render_mode==RENDER_BG ? S_RENDER_BG : S_RENDER_TEXT));
+#ifdef FF_PROFILE
+    iprintf(str(S_MENU_PROF), str(prof_show ? S_ON : S_OFF));
+#endif
+    iprintf(str(S_MENU_SEED), (unsigned long)session_seed);
+    str_print(S_MENU_BACK);
+}
+static void menu_draw_help(){
+    menu_page=MENU_HELP;
+    cls();
+    str_print(S_HELP_TITLE);
+    for(int i=0;i<MISSION_DEF_COUNT;i++) iprintf(str(S_HELP_MISSION), mission_done[i]?'X':' ', str(MISSION_DEFS[i].title), str(MISSION_DEFS[i].desc));
+    str_print(S_HELP);
+}
+
+// Pagina Box: cursore sulla vista, righe della pagina lette da SRAM solo
+// quando la pagina cambia (box_page_top) o il Box viene modificato.
+static int box_cur, box_page_top=-1;
+static Creature box_page[BOX_PAGE];
+static u8 box_page_ok[BOX_PAGE];
+
+static void box_draw_rows(){
+    int top=box_cur-box_cur%BOX_PAGE;
+    if (top!=box_page_top){
+        for(int r=0;r<BOX_PAGE && top+r<box_view_n;r++) box_page_ok[r]=(u8)box_read(box_view[top+r], &box_page[r]);
+        box_page_top=top;
+    }
+    for(int r=0;r<BOX_PAGE;r++){
+        iprintf("\x1b[%d;0H", 3+r);
+        const Creature* c=&box_page[r];
+        if (top+r>=box_view_n) iprintf("%-29s", "");
+        else if (!box_page_ok[r]) iprintf("%c %-27s", top+r==box_cur?'>':' ', str(S_BOX_BAD));
+        else iprintf(str(S_BOX_ROW), top+r==box_cur?'>':' ', creature_name(c), ELEM_NAME[creature_type(c)], c->hp, c->max_hp);
+    }
+}
+static BoxAccess box_access;
+
+static void menu_draw_box(){
+    menu_page=MENU_BOX;
+    box_access=box_sync();
+    cls();
+    if (box_access!=BOX_OK){ str_print(box_access==BOX_UNSAVED ? S_BOX_LOCKED_UNSAVED : S_BOX_LOCKED_FOREIGN); return; }
+    box_build_view();
+    if (box_cur>=box_view_n) box_cur = box_view_n>0 ? box_view_n-1 : 0;
+    box_page_top=-1;
+    iprintf(str(S_BOX_TITLE), box_count, BOX_CAP);
+    iprintf(str(S_BOX_FILTER), box_filter<0 ? str(S_BOX_ALL) : ELEM_NAME[box_filter], str(box_by_species ? S_BOX_BY_SPECIES : S_BOX_BY_CATCH));
+    box_draw_rows();
+    iprintf("\x1b[14;0H"); str_print(S_BOX_KEYS);
+}
+static void box_update(u16 kd){
+    if (kd & (KEY_B|KEY_START)){ menu_draw_main(); return; }
+    if (box_access!=BOX_OK) return;
+    if (kd & (KEY_L|KEY_R)){
+        box_filter += (kd & KEY_R) ? 1 : -1;
+        if (box_filter>=TYPE_COUNT) box_filter=-1;
+        if (box_filter<-1) box_filter=TYPE_COUNT-1;
+        box_cur=0; menu_draw_box(); return;
+    }
+    if (kd & KEY_SELECT){ box_by_species^=1; box_cur=0; menu_draw_box(); return; }
+    if (kd & KEY_A && box_view_n>0){
+        int rec=box_view[box_cur];
+        Creature c;
+        if (!box_read(rec, &c)) return;
+        if (companion_count<MAX_COMPANIONS){ companions[companion_count++]=c; box_remove(rec); }
+        else { box_replace(rec, &companions[companion_count-1]); companions[companion_count-1]=c; }
+        save_game();                    // squadra e Box nello stesso salvataggio
+        menu_draw_box(); return;
+    }
+    u16 mv=input.repeat;
+    int cur=box_cur;
+    if ((mv & KEY_UP) && cur>0) cur--;
+    if ((mv & KEY_DOWN) && cur+1<box_view_n) cur++;
+    if (cur!=box_cur){ box_cur=cur; box_draw_rows(); }
+}
+
+static void menu_update(){
+    u16 kd = input.pressed;
+    if (menu_page==MENU_HELP){ if (kd & (KEY_B|KEY_START)) menu_draw_main(); return; }
+    if (menu_page==MENU_BOX){ box_update(kd); return; }
+    if (kd & (KEY_B|KEY_START)){ set_state(GS_WORLD); return; }
+    if (kd & KEY_A){ menu_draw_help(); return; }
+    if (kd & KEY_RIGHT){ menu_draw_box(); return; }
+    if (kd & KEY_SELECT){ save_game(); str_print(S_SAVED); }
+    if (kd & KEY_L){ render_mode ^= 1; menu_draw_main(); return; }
+#ifdef FF_PROFILE
+    if (kd & KEY_DOWN){ prof_show ^= 1; prof_age=0; menu_draw_main(); return; }
+#endif
+    if (kd & KEY_R){ int ok=load_game(); if (ok){ enemies_clear(); flow_invalidate(); } str_print(ok ? S_LOADED : S_NO_SAVE); }   // mappa e giocatore nuovi: il campo si rifa'
+}
+
+// Mondo (GS_WORLD) ------------------------------------------------------------
+static void world_enter(){ cls(); }
+
+static void world_update(){
+    u16 kd = input.pressed;
+    u16 held = input.held;
+
+    // Un task di fondo (contatto con un nemico) ha gia' chiesto la battaglia:
+    // START o un incontro in questo frame la sovrascriverebbero.
+    if (gstate_next!=GS_WORLD) return;
+    if (kd & KEY_START){ set_state(GS_MENU); return; }
+    if (kd & KEY_SELECT){ try_craft_quick(); }
+    if (kd & KEY_L){ sel_build_idx = (sel_build_idx-1+4)%4; }
+    if (kd & KEY_R){ sel_build_idx = (sel_build_idx+1)%4; }
+    if ((held & KEY_R) && (kd & KEY_A)){ try_throw_orb(); }
+    if ((held & KEY_L) && (kd & KEY_A)){ try_build(); }
+
+    int dx=0, dy=0;
+    u16 mv = input.repeat;      // pressione + autorepeat ogni REPEAT_RATE frame
+    if (mv & KEY_UP) dy=-1;
+    else if (mv & KEY_DOWN) dy=1;
+    else if (mv & KEY_LEFT) dx=-1;
+    else if (mv & KEY_RIGHT) dx=1;
+    if (dx||dy){
+        int nx=player.x+dx, ny=player.y+dy;
+        if (nx>=1 && nx<MAP_W-1 && ny>=1 && ny<MAP_H-1){
+            if ((TILE_PROPS[map_get(nx,ny)].flags & TF_PASS) && occ_find(nx,ny)==OCC_NONE){
+                view_mark_cell(player.x, player.y); mm_mark(player.x, player.y);
+                player.x=nx; player.y=ny; player.steps++;
+                view_mark_cell(player.x, player.y); mm_mark(player.x, player.y);
             }
-            if (kd & KEY_SELECT){ save_game(&player, companions, companion_count, MISSIONS); iprintf("\nSalvato su SRAM!"); }
-            if (kd & KEY_R){ int ok=load_game(&player, companions, &companion_count, MISSIONS); iprintf(ok? "\nCaricato da SRAM!":"\nNessun salvataggio."); }
-            wait_vblank();
         }
     }
+    if (kd & KEY_A){ PROF(PROF_GATHER, try_gather_or_action()); }
+
+    if (is_night() && near_boss_area()){
+        // Simple boss trigger: bonus loot
+        if (rng_range(RNG_LOOT,0,99)<5){ player.orbs += 2; show_msg(40, str(S_BOSS_TRACES)); }
+    }
+
+    PROF(PROF_VIEW, draw_view());
+    PROF(PROF_SPRITES, obj_build());
+    PROF(PROF_MINIMAP, draw_minimap());
+    PROF(PROF_HUD, draw_hud());
+    tick_msg();
+#ifdef FF_PROFILE
+    if (prof_show) prof_overlay();
+#endif
+}
+
+// Scheduler ------------------------------------------------------------------
+// Ogni schermata e' uno stato con enter() (disegno statico) e update() (un
+// frame di logica, mai bloccante). Ogni frame main() chiama l'update dello
+// stato corrente, applica il cambio di stato richiesto con set_state(), poi
+// esegue i task di fondo entro BG_BUDGET unita' di lavoro: il mondo continua
+// ad avanzare con menu, dialoghi e battaglie aperti e nessuna schermata tiene
+// la CPU oltre il frame. Il budget e' in unita' fisse, non in tempo, cosi'
+// una sessione riprodotta dal log degli input resta identica.
+typedef struct { void (*enter)(void); void (*update)(void); } StateDef;
+static const StateDef STATES[] = {
+    [GS_WORLD]  = { world_enter,  world_update },
+    [GS_BATTLE] = { battle_enter, battle_update },
+    [GS_MSG]    = { talk_enter,   talk_update },
+    [GS_MENU]   = { menu_draw_main, menu_update },
+    // GS_BOSS: riservato, nessuna schermata dedicata per ora.
+};
+
+// Task di fondo: ricevono il budget rimasto e ritornano le unita' spese.
+// Unita': un blocco SAVE_BLOCK scritto, un frame di IA dei nemici o un tick
+// degli edifici. L'autosalvataggio gira in ogni stato ma ne comincia uno solo
+// fuori dal menu e per una sessione che possiede la SRAM (save_is_ours()).
+#define BG_BUDGET 6             // 4 blocchi di salvataggio + IA + edifici: nessun task salta il turno
+#define SAVE_STEP_BLOCKS 4      // blocchi di autosalvataggio al massimo per frame
+static int autosave_task(int budget){
+    if (save_block<0){
+        if (gstate==GS_MENU) return 0;      // dal menu si carica: niente fotografie nuove
+        if (++autosave_timer<AUTOSAVE_FRAMES) return 0;
+        if (!save_is_ours()){ autosave_timer=0; return 0; }
+        save_begin();
+    }
+    return save_step(budget<SAVE_STEP_BLOCKS ? budget : SAVE_STEP_BLOCKS);
+}
+static int enemy_task(int budget){ (void)budget; enemies_step(); return 1; }
+static int building_task(int budget){
+    (void)budget;
+    if (++bld_timer<BLD_TICK_FRAMES) return 0;
+    bld_timer=0; buildings_tick();
+    return 1;
+}
+static int (*const BG_TASKS[])(int budget) = { autosave_task, enemy_task, building_task };
+#define BG_TASK_COUNT ((int)(sizeof(BG_TASKS)/sizeof(BG_TASKS[0])))
+static int bg_next;             // round robin: a turno un task parte per primo
+
+static void run_background(){
+    int budget=BG_BUDGET, j=bg_next;
+    for(int i=0;i<BG_TASK_COUNT && budget>0;i++){
+        budget -= BG_TASKS[j](budget);
+        if (++j==BG_TASK_COUNT) j=0;        // niente modulo: sul GBA sarebbe una divisione software
+    }
+    if (++bg_next>=BG_TASK_COUNT) bg_next=0;
+}
+
+static void schedule_frame(){
+    STATES[gstate].update();
+    if (gstate_next!=gstate){ gstate=gstate_next; STATES[gstate].enter(); }
+    run_background();
 }
 
 // Game loop ------------------------------------------------------------------
 int main(void){
-    irqInit(); irqEnable(IRQ_VBLANK); consoleDemoInit(); seed_rng(); build_map(); gstate=GS_WORLD;
+    irqInit(); irqSet(IRQ_VBLANK, vblank_isr); irqEnable(IRQ_VBLANK);
+    consoleDemoInit(); bg_init(); obj_init(); gstate=gstate_next=GS_WORLD;
+#ifdef FF_PROFILE
+    prof_init();
+#endif
+    input_poll();
 
     cls();
-    iprintf("FaunaFrontierGBA — Enhanced\nPremi A per iniziare...");
-    while(1){ if (key_down() & KEY_A) break; wait_vblank(); }
+    str_print(S_TITLE);
+    u32 title_frames=0;
+    while(!(input.pressed & KEY_A)){ title_frames++; wait_vblank(); }
+    // Seme: frame d'attesa sul titolo (entropia del giocatore), o fisso con -DFF_SEED=n per rigiocare.
+#ifdef FF_SEED
+    (void)title_frames; rng_seed(FF_SEED);
+#else
+    rng_seed(hash32(title_frames ^ ((u32)REG_VCOUNT<<16)));
+#endif
+    PROF(PROF_BUILD_MAP, build_map());
     cls();
 
-    int move_cd=0;
-
     while(1){
-        u16 kd = key_down();
-        u16 held = key_held();
-
-        if (kd & KEY_START){ show_menu(); cls(); }
-        if (kd & KEY_SELECT){ try_craft_quick(); }
-        if (kd & KEY_L){ sel_build_idx = (sel_build_idx-1+4)%4; }
-        if (kd & KEY_R){ sel_build_idx = (sel_build_idx+1)%4; }
-        if ((held & KEY_R) && (kd & KEY_A)){ try_throw_orb(); }
-        if ((held & KEY_L) && (kd & KEY_A)){ try_build(); }
-
-        if (gstate==GS_WORLD){
-            if (move_cd>0) move_cd--;
-            int dx=0, dy=0;
-            if (move_cd==0){
-                if (held & KEY_UP){ dy=-1; move_cd=3; }
-                else if (held & KEY_DOWN){ dy=1; move_cd=3; }
-                else if (held & KEY_LEFT){ dx=-1; move_cd=3; }
-                else if (held & KEY_RIGHT){ dx=1; move_cd=3; }
-                if (dx||dy){
-                    int nx=player.x+dx, ny=player.y+dy;
-                    if (nx>=1 && nx<MAP_W-1 && ny>=1 && ny<MAP_H-1){
-                        if (map_data[ny][nx]!=TILE_WALL && map_data[ny][nx]!=TILE_WATER){ player.x=nx; player.y=ny; player.steps++; }
-                    }
-                }
-            }
-            if (kd & KEY_A){ try_gather_or_action(); }
-
-            if (is_night() && near_boss_area()){
-                // Simple boss trigger: bonus loot
-                if (rand_range(0,99)<5){ player.orbs += 2; iprintf("Hai trovato tracce del Boss. +2 Sfere!"); msg_timer=40; }
-            }
-
-            draw_view();
-            draw_minimap();
-            draw_hud();
-            if (msg_timer>0) msg_timer--;
-        } else if (gstate==GS_BATTLE){
-            int res = do_battle(); (void)res;
-            gstate = GS_WORLD;
-            cls();
-        }
-
+        PROF(PROF_FRAME, schedule_frame());
         wait_vblank();
     }
     return 0;